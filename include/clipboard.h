@@ -0,0 +1,197 @@
+/** @file */
+
+#ifndef MICROWINDOW_CLIPBOARD_H
+#define MICROWINDOW_CLIPBOARD_H
+
+#include "error.h"
+#include "window.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Callback function for finished clipboard and drag and drop transfers
+ *
+ * A pointer to a function that is called once a data transfer started by μWindow has finished.
+ *
+ * The function must have the signature `void function(int fd, MW_Error status)`.
+ *
+ * @param fd The file descriptor the transfer was reading from or writing to:
+ *           - For receiving transfers, this is the destination `fd` passed to @ref MW_clipboard_receive or @ref MW_drop_receive
+ *           - For sending transfers, this is the source `fd` passed to @ref MW_clipboard_offer or @ref MW_Window_start_drag\n
+ *             The fd is still open while the callback runs, but may be closed right after it returns
+ * @param status **MW_SUCCESS** if all data was transferred or **MW_FAILED_TRANSFER** if the transfer was aborted
+ */
+typedef void (*MW_transfer_cb)(int fd, MW_Error status);
+
+
+/**
+ * @brief Sets a callback for finished data transfers
+ *
+ * All clipboard and drag and drop data is streamed from and to file descriptors while events are processed using
+ * @ref MW_process_events() or @ref MW_process_events_blocking().
+ * The data is moved with `splice` wherever possible and is never fully buffered in memory, so even very large transfers
+ * neither block the event loop nor use much memory.
+ *
+ * The callback set here is called once for every finished transfer.
+ * If a callback had already been set, the function overrides the previous callback.
+ * To unregister the callback function, simply pass NULL as the `callback` to this function.
+ *
+ * @param callback A pointer to the function which should be called for finished transfers
+ *
+ * @returns An @ref MW_Error code:
+ * - **MW_SUCCESS**: The callback was successfully set
+ * - **MW_NOT_INITIALISED**: The library has not been initialised yet
+ *     - @ref MW_init() has not yet been called or the call to @ref MW_init() was unsuccessful
+ */
+MW_Error MW_set_transfer_callback(MW_transfer_cb callback);
+
+
+/**
+ * @brief Gets the MIME types of the current clipboard content
+ *
+ * @param mime_types A pointer which is set to an array of the offered MIME types\n
+ *                   The array is owned by μWindow and stays valid until the next call to an event processing function
+ * @param mime_type_count A pointer which is set to the number of elements in `mime_types`
+ *
+ * @returns An @ref MW_Error code:
+ * - **MW_SUCCESS**: The MIME types were successfully returned
+ * - **MW_NOT_INITIALISED**: The library has not been initialised yet
+ *     - @ref MW_init() has not yet been called or the call to @ref MW_init() was unsuccessful
+ * - **MW_INVALID_PARAM**: An invalid parameter was passed to the function
+ *     - `mime_types` and `mime_type_count` cannot be NULL
+ * - **MW_NO_DATA_DEVICE**: The compositor does not support the clipboard
+ * - **MW_NO_DATA_OFFER**: The clipboard is empty
+ */
+MW_Error MW_clipboard_get_mime_types(const char *const **mime_types, size_t *mime_type_count);
+
+
+/**
+ * @brief Starts receiving the current clipboard content into a file descriptor
+ *
+ * The data is written to `fd` while events are processed. Once all data has been written, the callback set using
+ * @ref MW_set_transfer_callback is called with `fd`.
+ *
+ * @param mime_type The MIME type to receive the data in. This has to be one of the types returned by
+ *                  @ref MW_clipboard_get_mime_types
+ * @param fd The file descriptor to write the data to, usually a regular file or a memfd\n
+ *           The file descriptor is not closed by μWindow
+ *
+ * @returns An @ref MW_Error code:
+ * - **MW_SUCCESS**: The transfer was successfully started
+ * - **MW_NOT_INITIALISED**: The library has not been initialised yet
+ *     - @ref MW_init() has not yet been called or the call to @ref MW_init() was unsuccessful
+ * - **MW_INVALID_PARAM**: An invalid parameter was passed to the function
+ *     - `mime_type` has to be one of the offered MIME types and `fd` has to be a valid file descriptor
+ * - **MW_NO_DATA_DEVICE**: The compositor does not support the clipboard
+ * - **MW_NO_DATA_OFFER**: The clipboard is empty
+ * - **MW_FAILED_PIPE_CREATION**: Failed to create the pipe to receive the data through
+ * - **MW_OUT_OF_MEMORY**: Failed to allocate the transfer
+ */
+MW_Error MW_clipboard_receive(const char *mime_type, int fd);
+
+
+/**
+ * @brief Puts the contents of a file descriptor into the clipboard
+ *
+ * Whenever another application pastes the clipboard content, the data is streamed from `fd` to it while events are
+ * processed. Every paste sends the whole file, no matter what the current file position of `fd` is.
+ *
+ * @param mime_types An array of the MIME types the data should be offered as
+ * @param mime_type_count The number of elements in `mime_types`
+ * @param fd A seekable file descriptor containing the data, usually a regular file or a memfd\n
+ *           If the function returns **MW_SUCCESS**, μWindow takes ownership of the file descriptor and closes it once
+ *           the clipboard content is replaced and all pastes of it have finished. On any error, the caller keeps
+ *           ownership
+ *
+ * @returns An @ref MW_Error code:
+ * - **MW_SUCCESS**: The data was successfully put into the clipboard
+ * - **MW_NOT_INITIALISED**: The library has not been initialised yet
+ *     - @ref MW_init() has not yet been called or the call to @ref MW_init() was unsuccessful
+ * - **MW_INVALID_PARAM**: An invalid parameter was passed to the function
+ *     - `mime_types` cannot be NULL or empty and `fd` has to be a seekable file descriptor
+ * - **MW_NO_DATA_DEVICE**: The compositor does not support the clipboard
+ * - **MW_OUT_OF_MEMORY**: Failed to allocate the data source
+ *
+ * @note The compositor may ignore the request if none of the application's windows has received any input yet.
+ */
+MW_Error MW_clipboard_offer(const char *const *mime_types, size_t mime_type_count, int fd);
+
+
+/**
+ * @brief Sets a callback for data dropped onto a specific window
+ *
+ * Drags are only accepted by windows which have a drop callback set.
+ * If a callback for the window had already been set, the function overrides the previous callback.
+ * To unregister the callback function, simply pass NULL as the `callback` to this function.
+ *
+ * @param window The window to set the event handler function for
+ * @param callback A pointer to the function which should receive the drop events
+ *
+ * @returns An @ref MW_Error code:
+ * - **MW_SUCCESS**: The callback was successfully set
+ * - **MW_NOT_INITIALISED**: The library has not been initialised yet
+ *     - @ref MW_init() has not yet been called or the call to @ref MW_init() was unsuccessful
+ * - **MW_INVALID_WINDOW_STATE**: The passed window object is in an invalid state
+ */
+MW_Error MW_Window_set_drop_callback(MW_Window *window, MW_Window_drop_cb callback);
+
+
+/**
+ * @brief Starts receiving dropped data into a file descriptor
+ *
+ * This function works like @ref MW_clipboard_receive, but for the data that has just been dropped onto a window.
+ * It can only be called from within a @ref MW_Window_drop_cb.
+ *
+ * @param mime_type The MIME type to receive the data in. This has to be one of the types passed to the drop callback
+ * @param fd The file descriptor to write the data to, usually a regular file or a memfd\n
+ *           The file descriptor is not closed by μWindow
+ *
+ * @returns An @ref MW_Error code:
+ * - **MW_SUCCESS**: The transfer was successfully started
+ * - **MW_NOT_INITIALISED**: The library has not been initialised yet
+ *     - @ref MW_init() has not yet been called or the call to @ref MW_init() was unsuccessful
+ * - **MW_INVALID_PARAM**: An invalid parameter was passed to the function
+ *     - `mime_type` has to be one of the offered MIME types and `fd` has to be a valid file descriptor
+ * - **MW_NO_DATA_OFFER**: The function was not called from within a drop callback
+ * - **MW_FAILED_PIPE_CREATION**: Failed to create the pipe to receive the data through
+ * - **MW_OUT_OF_MEMORY**: Failed to allocate the transfer
+ */
+MW_Error MW_drop_receive(const char *mime_type, int fd);
+
+
+/**
+ * @brief Starts dragging the contents of a file descriptor out of a window
+ *
+ * This function has to be called while a mouse button is held down inside the window.
+ * If the data is dropped onto another window, it is streamed from `fd` the same way as with @ref MW_clipboard_offer.
+ *
+ * @param window The window the drag starts in
+ * @param mime_types An array of the MIME types the data should be offered as
+ * @param mime_type_count The number of elements in `mime_types`
+ * @param fd A seekable file descriptor containing the data, usually a regular file or a memfd\n
+ *           If the function returns **MW_SUCCESS**, μWindow takes ownership of the file descriptor and closes it once
+ *           the next drag is started and the transfer of the dropped data has finished. On any error, the caller keeps
+ *           ownership
+ *
+ * @returns An @ref MW_Error code:
+ * - **MW_SUCCESS**: The drag was successfully started
+ * - **MW_NOT_INITIALISED**: The library has not been initialised yet
+ *     - @ref MW_init() has not yet been called or the call to @ref MW_init() was unsuccessful
+ * - **MW_INVALID_WINDOW_STATE**: The passed window object is in an invalid state
+ * - **MW_INVALID_PARAM**: An invalid parameter was passed to the function
+ *     - `mime_types` cannot be NULL or empty and `fd` has to be a seekable file descriptor
+ * - **MW_NO_DATA_DEVICE**: The compositor does not support drag and drop
+ * - **MW_OUT_OF_MEMORY**: Failed to allocate the data source
+ */
+MW_Error MW_Window_start_drag(MW_Window *window, const char *const *mime_types, size_t mime_type_count, int fd);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,70 @@
+/** @file */
+
+#ifndef MICROWINDOW_CURSOR_H
+#define MICROWINDOW_CURSOR_H
+
+#include "error.h"
+#include "window.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Loads a cursor theme to take cursor images from
+ *
+ * μWindow does not draw the mouse cursor itself. Instead, it hands the images of the selected cursor theme to the
+ * compositor, which then moves the cursor around on its own. Moving the mouse therefore costs nothing in the
+ * application's render loop.
+ *
+ * @ref MW_init() already loads the default cursor theme, so this function only needs to be called if a different theme or
+ * cursor size should be used.
+ * The cursor of the window that the pointer is currently in is updated immediately.
+ *
+ * @param theme_name The name of the cursor theme to load\n
+ *                   NULL can be passed to use the theme in the `XCURSOR_THEME` environment variable or the system default
+ * @param size The size of the cursor in pixels\n
+ *             0 can be passed to use the size in the `XCURSOR_SIZE` environment variable or a default size
+ *
+ * @returns An @ref MW_Error code:
+ * - **MW_SUCCESS**: The cursor theme was successfully loaded
+ * - **MW_NOT_INITIALISED**: The library has not been initialised yet
+ *     - @ref MW_init() has not yet been called or the call to @ref MW_init() was unsuccessful
+ * - **MW_FAILED_CURSOR_THEME_LOAD**: Failed to load the cursor theme
+ *     - The compositor might not support shared memory buffers
+ *
+ * @note If the function fails, the previously loaded theme stays in use.
+ */
+MW_Error MW_set_cursor_theme(const char *theme_name, int size);
+
+
+/**
+ * @brief Sets the cursor that is shown while the pointer is inside a given window
+ *
+ * Every window starts out with the `left_ptr` cursor (the default arrow) of the current cursor theme.
+ * Animated cursors (like `watch` in most themes) are animated by μWindow as long as events are processed using
+ * @ref MW_process_events() or @ref MW_process_events_blocking().
+ *
+ * @param window The window to set the cursor for
+ * @param cursor_name The name of the cursor in the current cursor theme (for example `left_ptr`, `text` or `hand2`)\n
+ *                    NULL can be passed to hide the cursor while the pointer is inside the window
+ *
+ * @returns An @ref MW_Error code:
+ * - **MW_SUCCESS**: The cursor was successfully set
+ * - **MW_NOT_INITIALISED**: The library has not been initialised yet
+ *     - @ref MW_init() has not yet been called or the call to @ref MW_init() was unsuccessful
+ * - **MW_INVALID_WINDOW_STATE**: The passed window object is in an invalid state
+ * - **MW_INVALID_PARAM**: An invalid parameter was passed to the function
+ *     - `cursor_name` has to be shorter than @ref MW_CURSOR_NAME_MAX
+ * - **MW_NO_CURSOR_THEME**: No cursor theme is loaded, see @ref MW_set_cursor_theme
+ * - **MW_CURSOR_NOT_FOUND**: The current cursor theme does not contain a cursor called `cursor_name`
+ */
+MW_Error MW_Window_set_cursor(MW_Window *window, const char *cursor_name);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -3,6 +3,10 @@
 #ifndef MICROWINDOW_ERROR_H
 #define MICROWINDOW_ERROR_H
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 
 /** @brief An generic error type enum for all library functions
  *
@@ -29,7 +33,23 @@ typedef enum {
     MW_FAILED_TO_SWAP_EGL_BUFFERS,
     MW_FAILED_DISPLAY_ROUNDTRIP,
     MW_FAILED_DISPLAY_DISPATCH,
-    MW_FAILED_DISPLAY_FLUSH
+    MW_FAILED_DISPLAY_FLUSH,
+    MW_NO_CURSOR_THEME,
+    MW_FAILED_CURSOR_THEME_LOAD,
+    MW_CURSOR_NOT_FOUND,
+    MW_OUT_OF_MEMORY,
+    MW_NO_DATA_DEVICE,
+    MW_NO_DATA_OFFER,
+    MW_FAILED_PIPE_CREATION,
+    MW_FAILED_TRANSFER,
+    MW_FAILED_EGL_CONTEXT_CREATION,
+    MW_NO_BLOB_CACHE_EXTENSION,
+    MW_SHADER_CACHE_ALREADY_ENABLED,
+    MW_FAILED_SHADER_CACHE_OPEN,
+    MW_NO_PRESENT_THREAD_SUPPORT,
+    MW_PRESENT_THREAD_ALREADY_RUNNING,
+    MW_PRESENT_THREAD_NOT_RUNNING,
+    MW_FAILED_THREAD_CREATION
 } MW_Error;
 
 
@@ -44,4 +64,8 @@ typedef enum {
  */
 const char *MW_get_error_string(MW_Error error_code);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
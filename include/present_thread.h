@@ -0,0 +1,125 @@
+/** @file */
+
+#ifndef MICROWINDOW_PRESENT_THREAD_H
+#define MICROWINDOW_PRESENT_THREAD_H
+
+#include "error.h"
+#include "window.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief The largest number of frame buffers accepted by @ref MW_Window_start_present_thread
+ */
+#define MW_PRESENT_MAX_BUFFERS 4
+
+
+/**
+ * @brief Moves the presentation of a window onto a dedicated thread
+ *
+ * Normally @ref MW_Window_swap_buffers blocks the calling thread inside `eglSwapBuffers` whenever the compositor throttles
+ * the window. With a present thread, the application renders into one of `buffer_count` offscreen framebuffers owned by
+ * μWindow instead, and a thread owned by μWindow copies each finished frame into the window and swaps its buffers.
+ * The application's thread only blocks in @ref MW_Window_begin_frame when all framebuffers are still waiting to be presented.
+ *
+ * While the present thread is running, a frame is drawn like this:
+ * 1. @ref MW_Window_begin_frame waits for a free framebuffer, binds it and returns its size
+ * 2. The application draws into the bound framebuffer
+ * 3. @ref MW_Window_swap_buffers (or @ref MW_swap_buffers_batch) hands the frame over to the present thread and returns
+ *    without waiting for the compositor
+ *
+ * The window's OpenGL context stays the application's context, so all of its objects remain usable. It is made current
+ * without the window surface, which is current on the present thread instead, and presenting a frame only costs one blit.
+ * The framebuffers have an RGBA8 color texture and a 24-bit depth and 8-bit stencil buffer.
+ * The present thread waits for the compositor before presenting each frame, so frames are presented at most once per
+ * refresh of the display regardless of the window's swap interval.
+ *
+ * The present thread also handles all events of the window:
+ * - The resize and state callbacks of the window are called on the present thread. They can still be set (like
+ *   @ref MW_Window_set_skip_suspended_frames) from the application's thread at any time
+ * - The current size of the window is returned by @ref MW_Window_begin_frame. If the window is resized while a frame is
+ *   rendered, the frame is scaled to the new size when it is presented
+ * - If @ref MW_Window_set_skip_suspended_frames is enabled, the present thread drops frames while the window is suspended
+ *
+ * @param window The window to start the present thread for. After the function returns, the window's context is current
+ * @param buffer_count The number of framebuffers to render into, between 1 and @ref MW_PRESENT_MAX_BUFFERS\n
+ *                     With 2 framebuffers, the application can render the next frame while the last one is presented
+ *
+ * @returns An @ref MW_Error code:
+ * - **MW_SUCCESS**: The present thread was successfully started
+ * - **MW_NOT_INITIALISED**: The library has not been initialised yet
+ *     - @ref MW_init() has not yet been called or the call to @ref MW_init() was unsuccessful
+ * - **MW_INVALID_WINDOW_STATE**: The passed window object is in an invalid state
+ * - **MW_INVALID_PARAM**: An invalid parameter was passed to the function
+ *     - `buffer_count` has to be between 1 and @ref MW_PRESENT_MAX_BUFFERS
+ * - **MW_PRESENT_THREAD_ALREADY_RUNNING**: The window already has a present thread
+ * - **MW_NO_PRESENT_THREAD_SUPPORT**: The EGL implementation does not support `EGL_KHR_fence_sync`, `EGL_KHR_wait_sync`
+ *   and `EGL_KHR_surfaceless_context`
+ * - **MW_OUT_OF_MEMORY**: Failed to allocate the present thread's state
+ * - **MW_FAILED_OPENGL_API_BIND**: Failed to bind the OpenGL API
+ * - **MW_FAILED_EGL_CONTEXT_CREATION**: Failed to create the present thread's context
+ * - **MW_FAILED_TO_MAKE_EGL_CONTEXT_CURRENT**: Failed to make the window's context current without its surface
+ * - **MW_FAILED_THREAD_CREATION**: Failed to start the thread
+ */
+MW_Error MW_Window_start_present_thread(MW_Window *window, unsigned int buffer_count);
+
+
+/**
+ * @brief Starts rendering the next frame of a window with a present thread
+ *
+ * Makes the window's context current and binds a free framebuffer of the present thread as `GL_FRAMEBUFFER`.
+ * If all framebuffers are still waiting to be presented, the function blocks until the present thread has presented one.
+ * The viewport is set to the size of the framebuffer, which is the current size of the window.
+ *
+ * Calling the function again before the frame has been handed over with @ref MW_Window_swap_buffers binds the same
+ * framebuffer again.
+ *
+ * @param window The window to render the frame for
+ * @param width A pointer which is set to the width of the framebuffer
+ * @param height A pointer which is set to the height of the framebuffer
+ *
+ * @returns An @ref MW_Error code:
+ * - **MW_SUCCESS**: A framebuffer has successfully been bound
+ * - **MW_NOT_INITIALISED**: The library has not been initialised yet
+ *     - @ref MW_init() has not yet been called or the call to @ref MW_init() was unsuccessful
+ * - **MW_INVALID_WINDOW_STATE**: The passed window object is in an invalid state
+ * - **MW_INVALID_PARAM**: An invalid parameter was passed to the function
+ *     - `width` and `height` cannot be NULL
+ * - **MW_PRESENT_THREAD_NOT_RUNNING**: The window has no present thread
+ * - **MW_FAILED_TO_MAKE_EGL_CONTEXT_CURRENT**: Failed to make the window's context current
+ * - Any other code (usually **MW_FAILED_TO_SWAP_EGL_BUFFERS** or **MW_FAILED_DISPLAY_DISPATCH**): The present thread has
+ *   stopped because of this error. The window can only be presented again after calling @ref MW_Window_stop_present_thread
+ */
+MW_Error MW_Window_begin_frame(MW_Window *window, int32_t *width, int32_t *height);
+
+
+/**
+ * @brief Stops the present thread of a window
+ *
+ * Frames that have not been presented yet are dropped. Afterwards the window is presented by @ref MW_Window_swap_buffers on
+ * the calling thread again, its events are handled by the event processing functions again and it is the current window.
+ * The swap interval set with @ref MW_Window_set_swap_interval is restored.
+ * @ref MW_Window_destroy stops the present thread of a window automatically.
+ *
+ * @param window The window to stop the present thread of
+ *
+ * @returns An @ref MW_Error code:
+ * - **MW_SUCCESS**: The present thread was successfully stopped
+ * - **MW_NOT_INITIALISED**: The library has not been initialised yet
+ *     - @ref MW_init() has not yet been called or the call to @ref MW_init() was unsuccessful
+ * - **MW_INVALID_WINDOW_STATE**: The passed window object is in an invalid state
+ * - **MW_PRESENT_THREAD_NOT_RUNNING**: The window has no present thread
+ * - **MW_FAILED_TO_MAKE_EGL_CONTEXT_CURRENT**: The thread was stopped, but the window could not be made current
+ */
+MW_Error MW_Window_stop_present_thread(MW_Window *window);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,56 @@
+/** @file */
+
+#ifndef MICROWINDOW_SHADER_CACHE_H
+#define MICROWINDOW_SHADER_CACHE_H
+
+#include "error.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief The smallest cache file size accepted by @ref MW_enable_shader_cache
+ */
+#define MW_SHADER_CACHE_MIN_SIZE (64 * 1024)
+
+
+/**
+ * @brief Enables a persistent on-disk cache for compiled shaders and programs
+ *
+ * Without a cache, the OpenGL driver compiles every shader again on every start of the application.
+ * This function hands a cache to the driver using the `EGL_ANDROID_blob_cache` extension, so that shaders compiled once are
+ * loaded from disk on every following start.
+ *
+ * The cache is a single memory-mapped file of exactly `max_size` bytes, whose disk space is reserved when the cache is
+ * enabled. When it is full, the least recently used entries are evicted. Every entry is checksummed, so entries damaged
+ * by a crash are detected and dropped instead of being handed to the driver.
+ * The cache file may be shared by multiple running instances of the application.
+ *
+ * The function should be called right after @ref MW_init() and before creating any windows, since shaders compiled
+ * before the cache is enabled are not cached. It can only be called once per initialisation of the library.
+ *
+ * @param path The path of the cache file. The file is created if it does not exist yet, but its directory has to exist
+ * @param max_size The size of the cache file in bytes. Has to be at least @ref MW_SHADER_CACHE_MIN_SIZE\n
+ *                 If an existing cache file has a different size, its contents are discarded
+ *
+ * @returns An @ref MW_Error code:
+ * - **MW_SUCCESS**: The shader cache was successfully enabled
+ * - **MW_NOT_INITIALISED**: The library has not been initialised yet
+ *     - @ref MW_init() has not yet been called or the call to @ref MW_init() was unsuccessful
+ * - **MW_INVALID_PARAM**: An invalid parameter was passed to the function
+ *     - `path` cannot be NULL and `max_size` has to be at least @ref MW_SHADER_CACHE_MIN_SIZE
+ * - **MW_SHADER_CACHE_ALREADY_ENABLED**: The shader cache had already been enabled before this function call
+ * - **MW_NO_BLOB_CACHE_EXTENSION**: The EGL implementation does not support `EGL_ANDROID_blob_cache`
+ * - **MW_FAILED_SHADER_CACHE_OPEN**: Failed to create, resize or map the cache file, or to reserve its disk space
+ */
+MW_Error MW_enable_shader_cache(const char *path, size_t max_size);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
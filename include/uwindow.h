@@ -5,6 +5,14 @@
 
 #include "error.h"
 #include "window.h"
+#include "cursor.h"
+#include "clipboard.h"
+#include "shader_cache.h"
+#include "present_thread.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 
 /**
@@ -30,6 +38,9 @@
  *   **  - The host system might not have a wayland window manager installed
  * - **MW_FAILED_DISPLAY_DISPATCH** and **MW_FAILED_DISPLAY_ROUNDTRIP**: Failed to process wayland events
  *
+ * @note The default cursor theme is also loaded here. Failing to load it does not make the initialisation fail,
+ *       but @ref MW_Window_set_cursor will return **MW_NO_CURSOR_THEME** until @ref MW_set_cursor_theme succeeds.
+ *
  * @see @ref MW_finish()
  */
 MW_Error MW_init();
@@ -69,6 +80,8 @@ void MW_finish();
  * - **MW_FAILED_DISPLAY_ROUNDTRIP** and **MW_FAILED_DISPLAY_DISPATCH**: Failed to process wayland events
  * - **MW_FAILED_DISPLAY_FLUSH**: Failed to clear the event queue after processing the events
  *
+ * @note Clipboard and drag and drop transfers (see @ref clipboard.h) are advanced by this function without ever blocking.
+ *
  * @see @ref MW_process_events_blocking()
  */
 MW_Error MW_process_events();
@@ -82,16 +95,36 @@ MW_Error MW_process_events();
  * It may be used in cases where framerate is not an issue and the screen only updates upon events.
  * See `examples/blocking` for an example of such a use-case.
  *
+ * While clipboard or drag and drop transfers are in progress, the function also returns as soon as transfer data can be
+ * moved, so transfers keep progressing in event-driven programs.
+ *
  * @returns An @ref MW_Error code:
  * - **MW_SUCCESS**: All pending events were processes successfully or there were no events to process
  * - **MW_NOT_INITIALISED**: The library has not been initialised yet
  *     - @ref MW_init() has not yet been called or the call to @ref MW_init() was unsuccessful
  * - **MW_FAILED_DISPLAY_ROUNDTRIP** and **MW_FAILED_DISPLAY_DISPATCH**: Failed to process wayland events
+ * - **MW_OUT_OF_MEMORY**: Failed to allocate memory for waiting on the transfers in progress
  *
  * @see @ref MW_process_events()
  */
 MW_Error MW_process_events_blocking();
 
 
+/**
+ * @brief Returns the EGL display used by μWindow
+ *
+ * This can be used to call EGL functions (like `eglQueryString`) directly.
+ * The display stays valid until @ref MW_finish() is called.
+ *
+ * This function cannot fail.
+ *
+ * @returns The EGL display or `EGL_NO_DISPLAY` if the library has not been initialised
+ */
+EGLDisplay MW_get_egl_display();
+
+
+#ifdef __cplusplus
+}
 #endif
 
+#endif
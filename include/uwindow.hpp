@@ -0,0 +1,292 @@
+/** @file */
+
+#ifndef MW_MAIN_HPP
+#define MW_MAIN_HPP
+
+#include "uwindow.h"
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+
+/**
+ * @brief A header-only C++ wrapper around the μWindow C API
+ *
+ * The wrapper requires C++17. Errors are reported by throwing @ref uwindow::Error from constructors and setters.
+ * Everything that is validated by the C API on every call (whether the library is initialised and whether a window is in a
+ * valid state) is validated once when constructing a @ref uwindow::Library or @ref uwindow::Window.
+ * The per-frame functions @ref uwindow::Window::make_current and @ref uwindow::Window::swap_buffers can then call EGL
+ * directly and inline down to a single EGL call.
+ */
+namespace uwindow {
+
+/**
+ * @brief The exception thrown when a μWindow function fails
+ *
+ * The message of the exception is the string returned by @ref MW_get_error_string.
+ */
+class Error : public std::runtime_error {
+public:
+    /** @brief Creates an exception for an @ref MW_Error code */
+    explicit Error(MW_Error code) : std::runtime_error(MW_get_error_string(code)), code_(code) {}
+
+    /** @brief The @ref MW_Error code of the failed call */
+    MW_Error code() const noexcept { return code_; }
+
+private:
+    MW_Error code_;
+};
+
+
+namespace detail {
+
+inline void check(MW_Error status) {
+    if (status != MW_SUCCESS) {
+        throw Error(status);
+    }
+}
+
+struct WindowDeleter {
+    void operator()(MW_Window *window) const noexcept {
+        MW_Window_destroy(window);
+        delete window;
+    }
+};
+
+}
+
+
+/**
+ * @brief Initialises μWindow for the lifetime of the object
+ *
+ * Calls @ref MW_init() on construction and @ref MW_finish() on destruction.
+ * Only one Library object may exist at a time. It is move-only, and all @ref Window objects have to be destroyed
+ * before it.
+ */
+class Library {
+public:
+    /** @brief Initialises the library, throws @ref Error on failure */
+    Library() {
+        detail::check(MW_init());
+    }
+
+    ~Library() {
+        if (owns_) {
+            MW_finish();
+        }
+    }
+
+    Library(const Library &) = delete;
+    Library &operator=(const Library &) = delete;
+
+    /** @brief Takes over the initialised library from `other` */
+    Library(Library &&other) noexcept : owns_(std::exchange(other.owns_, false)) {}
+
+    /** @brief Takes over the initialised library from `other` */
+    Library &operator=(Library &&other) noexcept {
+        if (this != &other) {
+            if (owns_) {
+                MW_finish();
+            }
+            owns_ = std::exchange(other.owns_, false);
+        }
+        return *this;
+    }
+
+    /** @brief See @ref MW_process_events() */
+    void process_events() {
+        detail::check(MW_process_events());
+    }
+
+    /** @brief See @ref MW_process_events_blocking() */
+    void process_events_blocking() {
+        detail::check(MW_process_events_blocking());
+    }
+
+private:
+    bool owns_ = true;
+};
+
+
+/**
+ * @brief The default compile-time configuration of a @ref Window
+ *
+ * Custom traits can inherit from this struct and override single members:
+ *
+ *     struct MyTraits : uwindow::DefaultWindowTraits {
+ *         static constexpr EGLint context_attribs[] = {
+ *             EGL_CONTEXT_MAJOR_VERSION, 4,
+ *             EGL_CONTEXT_MINOR_VERSION, 5,
+ *             EGL_NONE
+ *         };
+ *         static constexpr EGLint swap_interval = 0;
+ *     };
+ *
+ *     uwindow::Window<MyTraits> window("Title");
+ */
+struct DefaultWindowTraits {
+    /** @brief Selects the EGL config: opaque windows use one without alpha, translucent windows one with alpha */
+    static constexpr MW_Window_transparency transparency = MW_WINDOW_OPAQUE;
+
+    /** @brief The `EGL_NONE`-terminated attributes passed to `eglCreateContext` */
+    static constexpr EGLint context_attribs[] = { EGL_NONE };
+
+    /**
+     * @brief The swap interval set with @ref MW_Window_set_swap_interval
+     *
+     * 1 waits for the compositor before every swap (vsync), 0 never waits.
+     * The EGL implementation may clamp the value.
+     */
+    static constexpr EGLint swap_interval = 1;
+};
+
+
+/**
+ * @brief An RAII window with a compile-time configuration
+ *
+ * Creates the window on construction and destroys it on destruction. Window objects are move-only.
+ * The underlying @ref MW_Window is heap-allocated, so its address stays the same when the Window object is moved.
+ *
+ * @tparam Traits The compile-time configuration of the window, see @ref DefaultWindowTraits
+ */
+template <typename Traits = DefaultWindowTraits>
+class Window {
+    static_assert(Traits::transparency == MW_WINDOW_OPAQUE || Traits::transparency == MW_WINDOW_TRANSLUCENT,
+            "Traits::transparency has to be a valid MW_Window_transparency value");
+    static_assert(Traits::context_attribs[sizeof(Traits::context_attribs) / sizeof(EGLint) - 1] == EGL_NONE,
+            "Traits::context_attribs has to be terminated by EGL_NONE");
+    static_assert(Traits::swap_interval >= 0, "Traits::swap_interval cannot be negative");
+
+public:
+    /**
+     * @brief Creates the window, see @ref MW_Window_create_with_attribs
+     *
+     * Like @ref MW_Window_create, this makes the new window current. The swap interval from the traits is then applied to it.
+     * Throws @ref Error on failure.
+     */
+    explicit Window(const char *title, int32_t preferred_width = 0, int32_t preferred_height = 0)
+            : window_(new MW_Window()) {
+        detail::check(MW_Window_create_with_attribs(window_.get(), title, preferred_width, preferred_height,
+                    Traits::transparency, Traits::context_attribs));
+        display_ = MW_get_egl_display();
+        detail::check(MW_Window_set_swap_interval(window_.get(), Traits::swap_interval));
+    }
+
+    Window(const Window &) = delete;
+    Window &operator=(const Window &) = delete;
+    Window(Window &&) noexcept = default;
+    Window &operator=(Window &&) noexcept = default;
+
+    /**
+     * @brief Makes the window current for OpenGL draw calls, see @ref MW_Window_make_current
+     *
+     * @returns Whether the context could be made current
+     */
+    bool make_current() noexcept {
+        if (window_->present_thread != nullptr) {
+            return MW_Window_make_current(window_.get()) == MW_SUCCESS;
+        }
+        return eglMakeCurrent(display_, window_->egl_surface, window_->egl_surface, window_->egl_context) == EGL_TRUE;
+    }
+
+    /**
+     * @brief Swaps the OpenGL buffers of the window, see @ref MW_Window_swap_buffers
+     *
+     * Like the C function, this does nothing while the window is suspended if @ref set_skip_suspended_frames is enabled.
+     *
+     * If the window has a present thread, the frame is handed over to it instead.
+     *
+     * @returns Whether the buffers could be swapped (or the swap was skipped)
+     */
+    bool swap_buffers() noexcept {
+        // The C function decides whether a frame is skipped or handed over, so only plain swaps are done here
+        if (window_->present_thread != nullptr || window_->skip_suspended_frames) {
+            return MW_Window_swap_buffers(window_.get()) == MW_SUCCESS;
+        }
+        return eglSwapBuffers(display_, window_->egl_surface) == EGL_TRUE;
+    }
+
+    /** @brief The current @ref MW_Window_state flags of the window */
+    uint32_t states() const noexcept {
+        if (window_->present_thread == nullptr) {
+            return window_->states;
+        }
+        // The present thread updates the states, so they are read through the C function which synchronises with it
+        uint32_t states = 0;
+        MW_Window_get_states(window_.get(), &states);
+        return states;
+    }
+
+    /** @brief See @ref MW_Window_start_present_thread */
+    void start_present_thread(unsigned int buffer_count = 2) {
+        detail::check(MW_Window_start_present_thread(window_.get(), buffer_count));
+    }
+
+    /**
+     * @brief Binds a free framebuffer of the present thread, see @ref MW_Window_begin_frame
+     *
+     * @returns The width and height of the framebuffer
+     */
+    std::pair<int32_t, int32_t> begin_frame() {
+        int32_t width;
+        int32_t height;
+        detail::check(MW_Window_begin_frame(window_.get(), &width, &height));
+        return { width, height };
+    }
+
+    /** @brief See @ref MW_Window_stop_present_thread */
+    void stop_present_thread() {
+        detail::check(MW_Window_stop_present_thread(window_.get()));
+    }
+
+    /** @brief See @ref MW_Window_set_resize_callback */
+    void set_resize_callback(MW_Window_resize_cb callback) {
+        detail::check(MW_Window_set_resize_callback(window_.get(), callback));
+    }
+
+    /** @brief See @ref MW_Window_set_fullscreen */
+    void set_fullscreen(bool fullscreen) {
+        detail::check(MW_Window_set_fullscreen(window_.get(), fullscreen));
+    }
+
+    /** @brief See @ref MW_Window_set_state_callback */
+    void set_state_callback(MW_Window_state_cb callback) {
+        detail::check(MW_Window_set_state_callback(window_.get(), callback));
+    }
+
+    /** @brief See @ref MW_Window_set_skip_suspended_frames */
+    void set_skip_suspended_frames(bool skip) {
+        detail::check(MW_Window_set_skip_suspended_frames(window_.get(), skip));
+    }
+
+    /** @brief See @ref MW_Window_set_cursor */
+    void set_cursor(const char *cursor_name) {
+        detail::check(MW_Window_set_cursor(window_.get(), cursor_name));
+    }
+
+    /** @brief See @ref MW_Window_set_drop_callback */
+    void set_drop_callback(MW_Window_drop_cb callback) {
+        detail::check(MW_Window_set_drop_callback(window_.get(), callback));
+    }
+
+    /** @brief See @ref MW_Window_set_opaque_region. Only available for translucent windows. */
+    void set_opaque_region(int32_t x, int32_t y, int32_t width, int32_t height) {
+        static_assert(Traits::transparency == MW_WINDOW_TRANSLUCENT,
+                "Opaque windows manage their opaque region automatically");
+        detail::check(MW_Window_set_opaque_region(window_.get(), x, y, width, height));
+    }
+
+    /** @brief The underlying @ref MW_Window, for calling C API functions that are not wrapped */
+    MW_Window *native() noexcept {
+        return window_.get();
+    }
+
+private:
+    std::unique_ptr<MW_Window, detail::WindowDeleter> window_;
+    EGLDisplay display_ = EGL_NO_DISPLAY;
+};
+
+}
+
+#endif
@@ -5,12 +5,95 @@
 
 #include "error.h"
 #include <stdint.h>
+#include <stddef.h>
 #include <stdbool.h>
 #include <wayland-client.h>
 #include <wayland-egl.h>
 #include <EGL/egl.h>
 #include "../src/xdg-shell-client-protocol.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief The maximum length (including the null-terminator) of a cursor name
+ *
+ * Cursor names passed to @ref MW_Window_set_cursor must be shorter than this.
+ */
+#define MW_CURSOR_NAME_MAX 64
+
+
+/**
+ * @brief How a window's contents are blended with whatever is behind the window
+ *
+ * Passed to @ref MW_Window_create_with_transparency. Telling the compositor which parts of a window are opaque lets it
+ * skip blending (and drawing whatever is hidden behind the window) for those parts.
+ */
+typedef enum {
+    /**
+     * @brief The window is fully opaque
+     *
+     * The window is drawn without an alpha channel (if the EGL implementation offers a config without one) and the whole
+     * window is always marked as opaque.
+     * This is the mode used by @ref MW_Window_create.
+     */
+    MW_WINDOW_OPAQUE = 0,
+
+    /**
+     * @brief The window may be translucent
+     *
+     * The window is drawn with an alpha channel and blended with whatever is behind it.
+     * Parts that are known to be opaque can be marked using @ref MW_Window_set_opaque_region.
+     */
+    MW_WINDOW_TRANSLUCENT
+} MW_Window_transparency;
+
+
+/**
+ * @brief The states a window can be in, as reported by the compositor
+ *
+ * A window's states are a combination of these flags. They are returned by @ref MW_Window_get_states and passed to the
+ * @ref MW_Window_state_cb.
+ */
+typedef enum {
+    /** @brief The window is maximized */
+    MW_WINDOW_STATE_MAXIMIZED = 1 << 0,
+
+    /** @brief The window is fullscreen */
+    MW_WINDOW_STATE_FULLSCREEN = 1 << 1,
+
+    /** @brief The window is being resized interactively by the user */
+    MW_WINDOW_STATE_RESIZING = 1 << 2,
+
+    /** @brief The window has the input focus */
+    MW_WINDOW_STATE_ACTIVATED = 1 << 3,
+
+    /**
+     * @brief The window is not visible at all
+     *
+     * The window may be minimized, on another workspace or fully covered by other windows.
+     * Frames drawn into a suspended window are never shown. See @ref MW_Window_set_skip_suspended_frames.
+     *
+     * @note This state is only reported by compositors supporting version 6 of the xdg-shell protocol.
+     */
+    MW_WINDOW_STATE_SUSPENDED = 1 << 4
+} MW_Window_state;
+
+
+/**
+ * @brief Callback function for window state changes
+ *
+ * A pointer to a function receiving window state change events.
+ *
+ * The function must have the signature `void function(uint32_t new_states, uint32_t changed_states)`.
+ *
+ * @param new_states The @ref MW_Window_state flags of the window after the change
+ * @param changed_states The @ref MW_Window_state flags that have been set or cleared by the change
+ */
+typedef void (*MW_Window_state_cb)(uint32_t new_states, uint32_t changed_states);
+
 
 /**
  * @brief Callback function for window resize events
@@ -25,6 +108,24 @@
 typedef void (*MW_Window_resize_cb)(int32_t new_width, int32_t new_height);
 
 
+/**
+ * @brief Callback function for data dropped onto a window
+ *
+ * A pointer to a function receiving drop events.
+ * The dropped data can be received by calling @ref MW_drop_receive from within this function.
+ *
+ * The function must have the signature `void function(const char *const *mime_types, size_t mime_type_count)`.
+ *
+ * @param mime_types An array of the MIME types the dropped data is available in
+ * @param mime_type_count The number of elements in `mime_types`
+ */
+typedef void (*MW_Window_drop_cb)(const char *const *mime_types, size_t mime_type_count);
+
+
+/** @brief The internal state of a window's present thread, see @ref MW_Window_start_present_thread */
+struct MW_PresentThread;
+
+
 /**
  * @brief The main window state object
  *
@@ -77,6 +178,54 @@ typedef struct {
     /** @brief A pointer to an EGL drawing context */
     EGLContext *egl_context;
 
+    /** @brief The EGL config the drawing context and surface were created with */
+    EGLConfig egl_config;
+
+    /** @brief Whether the window is opaque or may be translucent */
+    MW_Window_transparency transparency;
+
+    /**
+     * @brief The opaque region of a translucent window as set by the user
+     *
+     * This member and @ref MW_Window::opaque_y, @ref MW_Window::opaque_width and @ref MW_Window::opaque_height are set by
+     * @ref MW_Window_set_opaque_region. A width or height of 0 means that no part of the window is opaque.
+     * They are unused for opaque windows.
+     */
+    int32_t opaque_x;
+
+    /** @brief See @ref MW_Window::opaque_x */
+    int32_t opaque_y;
+
+    /** @brief See @ref MW_Window::opaque_x */
+    int32_t opaque_width;
+
+    /** @brief See @ref MW_Window::opaque_x */
+    int32_t opaque_height;
+
+    /** @brief The frame callback requested by the last @ref MW_swap_buffers_batch call (or `NULL` if it has been received) */
+    struct wl_callback *frame_callback;
+
+    /** @brief The swap interval of the window as set by @ref MW_Window_set_swap_interval (1 by default)
+     *
+     * EGL cannot be asked for the swap interval of a surface, so it is tracked here to restore it after batched swaps.
+     */
+    EGLint swap_interval;
+
+    /** @brief The current @ref MW_Window_state flags of the window */
+    uint32_t states;
+
+    /** @brief An internal variable for keeping track of window state changes until they are applied */
+    uint32_t pending_states;
+
+    /** @brief The user-provided window state callback (or `NULL` if none was provided)
+     *
+     * This member is initialised to `NULL` and set to a valid function once the user calls @ref MW_Window_set_state_callback.
+     */
+    MW_Window_state_cb state_cb;
+
+    /** @brief Whether buffer swaps are skipped while the window is suspended, see @ref MW_Window_set_skip_suspended_frames */
+    bool skip_suspended_frames;
+
     /** @brief An internal variable for keeping track of window resize events */
     bool resize_needed;
 
@@ -85,13 +234,33 @@ typedef struct {
      * This member is initialised to `NULL` and set to a valid function once the user calls @ref MW_Window_set_resize_callback.
      */
     MW_Window_resize_cb resize_cb;
+
+    /** @brief The name of the cursor shown while the pointer is inside the window
+     *
+     * This member is initialised to `left_ptr` and changed by calling @ref MW_Window_set_cursor.
+     * An empty string means that the cursor is hidden.
+     */
+    char cursor_name[MW_CURSOR_NAME_MAX];
+
+    /** @brief The user-provided drop callback (or `NULL` if none was provided)
+     *
+     * This member is initialised to `NULL` and set to a valid function once the user calls @ref MW_Window_set_drop_callback.
+     */
+    MW_Window_drop_cb drop_cb;
+
+    /** @brief The present thread of the window (or `NULL` if the window is presented by the application's thread)
+     *
+     * This member is set by @ref MW_Window_start_present_thread and reset by @ref MW_Window_stop_present_thread.
+     */
+    struct MW_PresentThread *present_thread;
 } MW_Window;
 
 
 /**
  * @brief Creates an @ref MW_Window object
  *
- * This function creates an @ref MW_Window object and sets it up for OpenGL drawing.
+ * This function creates an opaque @ref MW_Window object and sets it up for OpenGL drawing.
+ * For windows that should be see-through, use @ref MW_Window_create_with_transparency instead.
  * After creating the window, the function automatically opens the window and selects it for drawing using
  * @ref MW_Window_make_current.
  *
@@ -125,11 +294,98 @@ typedef struct {
  *          Always check the window size using a call like `glGetIntegerv` with `GL_VIEWPORT` before drawing any size-dependent
  *          graphics.
  *
- * @see @ref MW_Window_create_fullscreen @ref MW_Window_destroy
+ * @see @ref MW_Window_create_with_transparency @ref MW_Window_destroy
  */
 MW_Error MW_Window_create(MW_Window *window, const char *title, int32_t preferred_width, int32_t preferred_height);
 
 
+/**
+ * @brief Creates an @ref MW_Window object with an explicit transparency mode
+ *
+ * This function works exactly like @ref MW_Window_create, but additionally selects whether the window is opaque or may be
+ * translucent.
+ *
+ * Opaque windows are drawn without an alpha channel where possible and the compositor is always told that the whole window
+ * is opaque, so it never has to blend the window with what is behind it.
+ * Translucent windows are drawn with an alpha channel. By default the whole window is blended, but parts that are known to
+ * be opaque can be marked using @ref MW_Window_set_opaque_region.
+ *
+ * @param window A pointer to an allocated @ref MW_Window structure. This is usually a pointer to preallocated caller-local memory
+ * @param title The title of the window, which may or may not be shown by the window manager
+ * @param preferred_width A preferred width that the window should have, in case the window manager does dictate a window size\n
+ *                        0 can be passed for a default window width
+ * @param preferred_height A preferred height that the window should have, in case the window manager does dictate a window size\n
+ *                         0 can be passed for a default window height
+ * @param transparency Whether the window is opaque or may be translucent
+ *
+ * @returns An @ref MW_Error code:
+ * - All error codes returned by @ref MW_Window_create
+ * - **MW_INVALID_PARAM**: An invalid parameter was passed to the function
+ *     - `transparency` has to be a valid @ref MW_Window_transparency value
+ * - **MW_NO_EGL_CONFIG**: There is no EGL config with an alpha channel for translucent windows
+ *
+ * @see @ref MW_Window_create @ref MW_Window_set_opaque_region
+ */
+MW_Error MW_Window_create_with_transparency(MW_Window *window, const char *title, int32_t preferred_width,
+        int32_t preferred_height, MW_Window_transparency transparency);
+
+
+/**
+ * @brief Creates an @ref MW_Window object with an explicit transparency mode and EGL context attributes
+ *
+ * This function works exactly like @ref MW_Window_create_with_transparency, but additionally passes `context_attribs` to
+ * `eglCreateContext`. This can be used to request a specific OpenGL version or profile.
+ *
+ * @param window A pointer to an allocated @ref MW_Window structure. This is usually a pointer to preallocated caller-local memory
+ * @param title The title of the window, which may or may not be shown by the window manager
+ * @param preferred_width A preferred width that the window should have, in case the window manager does dictate a window size\n
+ *                        0 can be passed for a default window width
+ * @param preferred_height A preferred height that the window should have, in case the window manager does dictate a window size\n
+ *                         0 can be passed for a default window height
+ * @param transparency Whether the window is opaque or may be translucent
+ * @param context_attribs An `EGL_NONE`-terminated list of EGL context attributes (for example
+ *                        `EGL_CONTEXT_MAJOR_VERSION`)\n
+ *                        NULL can be passed for the default context attributes
+ *
+ * @returns An @ref MW_Error code:
+ * - All error codes returned by @ref MW_Window_create_with_transparency
+ * - **MW_FAILED_EGL_CONTEXT_CREATION**: The EGL context could not be created with the requested attributes
+ *
+ * @see @ref MW_Window_create_with_transparency
+ */
+MW_Error MW_Window_create_with_attribs(MW_Window *window, const char *title, int32_t preferred_width,
+        int32_t preferred_height, MW_Window_transparency transparency, const EGLint *context_attribs);
+
+
+/**
+ * @brief Marks a part of a translucent window as opaque
+ *
+ * The compositor does not need to blend the opaque part of a window with what is behind it, which saves work for every
+ * frame the compositor draws. The alpha values drawn into the opaque part are ignored.
+ *
+ * The region is given in surface coordinates and takes effect with the next call to @ref MW_Window_swap_buffers.
+ * It does not change when the window is resized.
+ *
+ * @param window The translucent window to set the opaque region for
+ * @param x The left edge of the opaque region
+ * @param y The top edge of the opaque region
+ * @param width The width of the opaque region
+ * @param height The height of the opaque region\n
+ *               If `width` or `height` is 0, no part of the window is opaque
+ *
+ * @returns An @ref MW_Error code:
+ * - **MW_SUCCESS**: The opaque region was successfully set
+ * - **MW_NOT_INITIALISED**: The library has not been initialised yet
+ *     - @ref MW_init() has not yet been called or the call to @ref MW_init() was unsuccessful
+ * - **MW_INVALID_WINDOW_STATE**: The passed window object is in an invalid state
+ *     - The window has to have been created as @ref MW_WINDOW_TRANSLUCENT. Opaque windows manage their opaque region
+ *       automatically.
+ * - **MW_INVALID_PARAM**: An invalid parameter was passed to the function
+ *     - `width` and `height` cannot be negative
+ */
+MW_Error MW_Window_set_opaque_region(MW_Window *window, int32_t x, int32_t y, int32_t width, int32_t height);
+
+
 /**
  * @brief Sets a callback for a resize event of a specific window
  *
@@ -152,6 +408,95 @@ MW_Error MW_Window_create(MW_Window *window, const char *title, int32_t preferre
 MW_Error MW_Window_set_resize_callback(MW_Window *window, MW_Window_resize_cb callback);
 
 
+/**
+ * @brief Sets a callback for state changes of a specific window
+ *
+ * This function sets a callback function for receiving window state change events.
+ * After calling this function, the function specified in the parameter `callback` is called every time the
+ * compositor changes the @ref MW_Window_state flags of the window `window`, for example when the window gains focus or
+ * becomes invisible.
+ *
+ * If a callback for the window had already been set, the function overrides the previous callback.
+ * To unregister the callback function, simply pass NULL as the `callback` to this function.
+ *
+ * @param window The window to set the event handler function for
+ * @param callback A pointer to the function which should receive the window state change events
+ *
+ * @returns An @ref MW_Error code:
+ * - **MW_SUCCESS**: The callback was successfully set
+ * - **MW_NOT_INITIALISED**: The library has not been initialised yet
+ *     - @ref MW_init() has not yet been called or the call to @ref MW_init() was unsuccessful
+ * - **MW_INVALID_WINDOW_STATE**: The passed window object is in an invalid state
+ */
+MW_Error MW_Window_set_state_callback(MW_Window *window, MW_Window_state_cb callback);
+
+
+/**
+ * @brief Gets the current states of a window
+ *
+ * @param window The window to get the states of
+ * @param states A pointer which is set to the current @ref MW_Window_state flags of the window
+ *
+ * @returns An @ref MW_Error code:
+ * - **MW_SUCCESS**: The states were successfully returned
+ * - **MW_NOT_INITIALISED**: The library has not been initialised yet
+ *     - @ref MW_init() has not yet been called or the call to @ref MW_init() was unsuccessful
+ * - **MW_INVALID_WINDOW_STATE**: The passed window object is in an invalid state
+ * - **MW_INVALID_PARAM**: An invalid parameter was passed to the function
+ *     - `states` cannot be NULL
+ */
+MW_Error MW_Window_get_states(MW_Window *window, uint32_t *states);
+
+
+/**
+ * @brief Sets whether frames of a suspended window are skipped
+ *
+ * While a window is suspended (see @ref MW_WINDOW_STATE_SUSPENDED), nothing drawn into it is ever shown.
+ * With this option enabled, @ref MW_Window_swap_buffers returns immediately without swapping while the window is
+ * suspended, and @ref MW_swap_buffers_batch leaves the window out of the batch.
+ * The application can then keep its frame loop unchanged, but should still skip drawing into suspended windows to avoid
+ * wasting GPU time. The option is disabled by default.
+ *
+ * Regardless of this option, @ref MW_swap_buffers_batch never waits for suspended windows.
+ *
+ * @param window The window to set the option for
+ * @param skip Whether buffer swaps should be skipped while the window is suspended
+ *
+ * @returns An @ref MW_Error code:
+ * - **MW_SUCCESS**: The option was successfully set
+ * - **MW_NOT_INITIALISED**: The library has not been initialised yet
+ *     - @ref MW_init() has not yet been called or the call to @ref MW_init() was unsuccessful
+ * - **MW_INVALID_WINDOW_STATE**: The passed window object is in an invalid state
+ */
+MW_Error MW_Window_set_skip_suspended_frames(MW_Window *window, bool skip);
+
+
+/**
+ * @brief Sets how many display refreshes @ref MW_Window_swap_buffers waits for before presenting a frame
+ *
+ * This function should be used instead of calling `eglSwapInterval` directly, since μWindow has to know the interval to
+ * restore it after @ref MW_swap_buffers_batch.
+ * The current drawing context is kept: the window is only made current while its interval is set.
+ *
+ * If the window has a present thread, the interval is only stored and applied once the present thread is stopped, since
+ * the present thread paces the window itself.
+ *
+ * @param window The window to set the swap interval for
+ * @param interval 1 waits for the compositor before every swap (vsync), 0 never waits. Windows start with an interval of 1\n
+ *                 The EGL implementation may clamp the value
+ *
+ * @returns An @ref MW_Error code:
+ * - **MW_SUCCESS**: The swap interval was successfully set
+ * - **MW_NOT_INITIALISED**: The library has not been initialised yet
+ *     - @ref MW_init() has not yet been called or the call to @ref MW_init() was unsuccessful
+ * - **MW_INVALID_WINDOW_STATE**: The passed window object is in an invalid state
+ * - **MW_INVALID_PARAM**: An invalid parameter was passed to the function
+ *     - `interval` cannot be negative
+ * - **MW_FAILED_TO_MAKE_EGL_CONTEXT_CURRENT**: Failed to switch to the window's drawing context to set the interval
+ */
+MW_Error MW_Window_set_swap_interval(MW_Window *window, EGLint interval);
+
+
 /**
  * @brief Sets the specified window as the current one for OpenGL draw calls
  *
@@ -166,6 +511,9 @@ MW_Error MW_Window_set_resize_callback(MW_Window *window, MW_Window_resize_cb ca
  *     - @ref MW_init() has not yet been called or the call to @ref MW_init() was unsuccessful
  * - **MW_INVALID_WINDOW_STATE**: The passed window object is in an invalid state
  * - **MW_FAILED_TO_MAKE_EGL_CONTEXT_CURRENT**: Failed to switch the drawing context
+ *
+ * @note If the window has a present thread, its context is made current without the window surface and the framebuffer of
+ *       the frame begun with @ref MW_Window_begin_frame is bound again, see @ref MW_Window_start_present_thread.
  */
 MW_Error MW_Window_make_current(MW_Window *window);
 
@@ -185,10 +533,61 @@ MW_Error MW_Window_make_current(MW_Window *window);
  *     - @ref MW_init() has not yet been called or the call to @ref MW_init() was unsuccessful
  * - **MW_INVALID_WINDOW_STATE**: The passed window object is in an invalid state
  * - **MW_FAILED_TO_SWAP_EGL_BUFFERS**: The buffer swap failed
+ *
+ * @note If @ref MW_Window_set_skip_suspended_frames is enabled for the window and the window is suspended,
+ *       this function returns **MW_SUCCESS** without swapping the buffers.
+ *
+ * @note If the window has a present thread, this function hands the frame begun with @ref MW_Window_begin_frame over to the
+ *       present thread and returns right away, see @ref MW_Window_start_present_thread.
+ *       It returns **MW_INVALID_WINDOW_STATE** if no frame has been begun, or the error that stopped the present thread.
  */
 MW_Error MW_Window_swap_buffers(MW_Window *window);
 
 
+/**
+ * @brief Swaps the OpenGL buffers of multiple windows at once
+ *
+ * Calling @ref MW_Window_swap_buffers for many windows in a row makes every window wait for the compositor on its own, so
+ * one frame of an application with many windows wakes the application and the compositor up once per window.
+ * This function paces a whole set of windows together instead:
+ * - It waits once (using frame callbacks) until the compositor is ready for the next frame of all windows in the batch
+ * - It swaps the buffers of all windows without waiting for the compositor in between
+ * - It flushes any remaining requests to the compositor once at the end
+ *
+ * @warning The windows are not presented atomically. `eglSwapBuffers` commits and flushes every window's new buffer to
+ *          the compositor itself, so the compositor receives the frames one window at a time and may show some windows of
+ *          the batch a frame earlier than others. Applications with many windows should not rely on all of them changing
+ *          in the same compositor frame.
+ *
+ * @param windows An array of pointers to the windows to swap the buffers of
+ * @param window_count The number of elements in `windows`
+ *
+ * @returns An @ref MW_Error code:
+ * - **MW_SUCCESS**: The buffers of all windows have successfully been swapped
+ * - **MW_NOT_INITIALISED**: The library has not been initialised yet
+ *     - @ref MW_init() has not yet been called or the call to @ref MW_init() was unsuccessful
+ * - **MW_INVALID_PARAM**: An invalid parameter was passed to the function
+ *     - `windows` and its elements cannot be NULL
+ * - **MW_INVALID_WINDOW_STATE**: One of the passed window objects is in an invalid state
+ * - **MW_FAILED_DISPLAY_DISPATCH**: Failed to process wayland events while waiting for the compositor
+ * - **MW_FAILED_TO_MAKE_EGL_CONTEXT_CURRENT**: Failed to switch to the drawing context of a window
+ * - **MW_FAILED_TO_SWAP_EGL_BUFFERS**: The buffer swap of a window failed
+ * - **MW_FAILED_DISPLAY_FLUSH**: Failed to send the frame to the compositor
+ *
+ * @note This function switches the drawing context. After it returns, the last window in `windows` is the current one.
+ *
+ * @note The compositor pacing is done by this function for all windows in the batch, so each batched swap is made with a
+ *       swap interval of 0. Afterwards the interval set with @ref MW_Window_set_swap_interval is restored, so later calls
+ *       to @ref MW_Window_swap_buffers are paced as before.
+ *
+ * @note Windows with a present thread are handed over to their present thread like with @ref MW_Window_swap_buffers and
+ *       are not waited for.
+ *
+ * @see @ref MW_Window_swap_buffers
+ */
+MW_Error MW_swap_buffers_batch(MW_Window *const *windows, size_t window_count);
+
+
 /**
  * @brief Sets an @ref MW_Window to fullscreen or windowed mode
  *
@@ -227,5 +626,8 @@ MW_Error MW_Window_set_fullscreen(MW_Window *window, bool fullscreen);
 void MW_Window_destroy(MW_Window *window);
 
 
+#ifdef __cplusplus
+}
 #endif
 
+#endif
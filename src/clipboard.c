@@ -0,0 +1,614 @@
+// splice() and pipe2() are Linux specific
+#define _GNU_SOURCE
+
+#include "../include/uwindow.h"
+#include "internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+// How many bytes are moved through a single splice / read / write call
+#define TRANSFER_CHUNK_SIZE (64 * 1024)
+
+// How many bytes a single transfer may move per call to MW_transfers_process, so that the event loop stays responsive
+#define TRANSFER_BUDGET (4 * 1024 * 1024)
+
+
+// Transfers
+
+typedef enum {
+    TRANSFER_DONE,
+    TRANSFER_PENDING,
+    TRANSFER_FAILED
+} TransferStatus;
+
+static MW_Transfer *transfer_add(int in_fd, int out_fd, int user_fd, MW_DataSource *source) {
+    MW_Transfer *transfer = malloc(sizeof(MW_Transfer));
+    if (transfer == NULL) {
+        return NULL;
+    }
+
+    *transfer = (const MW_Transfer) { 0 };
+    transfer->in_fd = in_fd;
+    transfer->out_fd = out_fd;
+    transfer->user_fd = user_fd;
+    transfer->sending = source != NULL;
+    transfer->source = source;
+    if (source != NULL) {
+        source->transfer_count++;
+    }
+
+    transfer->next = state.transfers;
+    state.transfers = transfer;
+    return transfer;
+}
+
+static void source_release(MW_DataSource *source);
+
+static void transfer_close(MW_Transfer *transfer) {
+    close(transfer->in_fd);
+    if (transfer->sending) {
+        close(transfer->out_fd);
+        source_release(transfer->source);
+    }
+    free(transfer->pending);
+    free(transfer);
+}
+
+static bool fd_writable(int fd) {
+    struct pollfd pollfd = { .fd = fd, .events = POLLOUT };
+    return poll(&pollfd, 1, 0) == 1 && (pollfd.revents & POLLOUT);
+}
+
+// Moves at most one chunk of data using read and write. The chunk is read from the user's file at the transfer offset
+// when sending, so that only the part that could actually be written is consumed.
+// When receiving, the data read from the pipe cannot be put back, so whatever the full destination did not accept is kept
+// in the transfer's pending buffer and written before anything else is read.
+static ssize_t transfer_copy_chunk(MW_Transfer *transfer) {
+    if (transfer->sending) {
+        char buffer[TRANSFER_CHUNK_SIZE];
+        ssize_t size = pread(transfer->in_fd, buffer, sizeof(buffer), transfer->offset);
+        if (size <= 0) {
+            return size;
+        }
+        ssize_t written = write(transfer->out_fd, buffer, size);
+        if (written > 0) {
+            transfer->offset += written;
+        }
+        return written;
+    }
+
+    if (transfer->pending_size > 0) {
+        ssize_t written = write(transfer->out_fd, transfer->pending + transfer->pending_offset, transfer->pending_size);
+        if (written > 0) {
+            transfer->pending_offset += written;
+            transfer->pending_size -= written;
+        }
+        return written;
+    }
+
+    if (transfer->pending == NULL) {
+        transfer->pending = malloc(TRANSFER_CHUNK_SIZE);
+        if (transfer->pending == NULL) {
+            errno = ENOMEM;
+            return -1;
+        }
+    }
+
+    ssize_t size = read(transfer->in_fd, transfer->pending, TRANSFER_CHUNK_SIZE);
+    if (size <= 0) {
+        return size;
+    }
+    ssize_t written = write(transfer->out_fd, transfer->pending, size);
+    if (written == -1) {
+        if (errno != EAGAIN && errno != EINTR) {
+            return -1;
+        }
+        written = 0;
+    }
+    transfer->pending_offset = written;
+    transfer->pending_size = size - written;
+    return size;
+}
+
+static ssize_t transfer_splice_chunk(MW_Transfer *transfer) {
+    loff_t offset = transfer->offset;
+    ssize_t size = splice(transfer->in_fd, transfer->sending ? &offset : NULL, transfer->out_fd, NULL,
+            TRANSFER_CHUNK_SIZE, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (size > 0) {
+        transfer->offset = offset;
+    }
+    return size;
+}
+
+static TransferStatus transfer_step(MW_Transfer *transfer) {
+    transfer->output_blocked = false;
+    size_t moved = 0;
+    while (moved < TRANSFER_BUDGET) {
+        ssize_t size = transfer->no_splice ? transfer_copy_chunk(transfer) : transfer_splice_chunk(transfer);
+
+        if (size > 0) {
+            moved += size;
+        } else if (size == 0) {
+            return TRANSFER_DONE;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN) {
+            // Either there is no data to read yet or the destination is full
+            transfer->output_blocked = !fd_writable(transfer->out_fd);
+            return TRANSFER_PENDING;
+        } else if (errno == EINVAL && !transfer->no_splice) {
+            // Neither fd is a pipe or the destination was opened with O_APPEND
+            transfer->no_splice = true;
+        } else {
+            return TRANSFER_FAILED;
+        }
+    }
+    return TRANSFER_PENDING;
+}
+
+void MW_transfers_process() {
+    if (state.transfers == NULL) {
+        return;
+    }
+
+    // Writing to a pipe whose reader has gone away raises SIGPIPE, which would kill the application.
+    // The signal is blocked while transferring and any SIGPIPE raised by a transfer is discarded afterwards,
+    // so that the application's own signal handling stays untouched.
+    sigset_t sigpipe_set;
+    sigset_t old_set;
+    sigemptyset(&sigpipe_set);
+    sigaddset(&sigpipe_set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &sigpipe_set, &old_set);
+
+    sigset_t pending_set;
+    sigpending(&pending_set);
+    bool sigpipe_was_pending = sigismember(&pending_set, SIGPIPE);
+
+    MW_Transfer **link = &state.transfers;
+    while (*link != NULL) {
+        MW_Transfer *transfer = *link;
+        TransferStatus status = transfer_step(transfer);
+        if (status == TRANSFER_PENDING) {
+            link = &transfer->next;
+            continue;
+        }
+
+        // The callback is called before the transfer is closed, since closing a sending transfer may close the reported fd
+        *link = transfer->next;
+        if (state.transfer_cb != NULL) {
+            state.transfer_cb(transfer->user_fd, status == TRANSFER_DONE ? MW_SUCCESS : MW_FAILED_TRANSFER);
+        }
+        transfer_close(transfer);
+    }
+
+    if (!sigpipe_was_pending) {
+        const struct timespec no_wait = { 0 };
+        sigtimedwait(&sigpipe_set, NULL, &no_wait);
+    }
+    pthread_sigmask(SIG_SETMASK, &old_set, NULL);
+}
+
+MW_Error MW_transfers_wait() {
+    size_t fd_count = 1;
+    for (MW_Transfer *transfer = state.transfers; transfer != NULL; transfer = transfer->next) {
+        fd_count++;
+    }
+
+    struct pollfd *fds = calloc(fd_count, sizeof(struct pollfd));
+    if (fds == NULL) {
+        return MW_OUT_OF_MEMORY;
+    }
+
+    fds[0].fd = wl_display_get_fd(state.display);
+    fds[0].events = POLLIN;
+    size_t i = 1;
+    for (MW_Transfer *transfer = state.transfers; transfer != NULL; transfer = transfer->next, i++) {
+        // Sending transfers wait for room in the receiver's pipe, receiving transfers for data in our pipe,
+        // unless their destination was full (polling the pipe would then return right away and never block)
+        bool wait_for_output = transfer->sending || transfer->output_blocked;
+        fds[i].fd = wait_for_output ? transfer->out_fd : transfer->in_fd;
+        fds[i].events = wait_for_output ? POLLOUT : POLLIN;
+    }
+
+    while (wl_display_prepare_read(state.display) != 0) {
+        if (wl_display_dispatch_pending(state.display) == -1) {
+            free(fds);
+            return MW_FAILED_DISPLAY_DISPATCH;
+        }
+    }
+    wl_display_flush(state.display);
+
+    int ready;
+    do {
+        ready = poll(fds, fd_count, -1);
+    } while (ready == -1 && errno == EINTR);
+
+    MW_Error status = MW_SUCCESS;
+    if (ready > 0 && (fds[0].revents & POLLIN)) {
+        if (wl_display_read_events(state.display) == -1) {
+            status = MW_FAILED_DISPLAY_DISPATCH;
+        }
+    } else {
+        wl_display_cancel_read(state.display);
+    }
+    free(fds);
+
+    if (status == MW_SUCCESS && wl_display_dispatch_pending(state.display) == -1) {
+        status = MW_FAILED_DISPLAY_DISPATCH;
+    }
+    return status;
+}
+
+
+// Offers
+
+static bool offer_has_mime_type(MW_DataOffer *offer, const char *mime_type) {
+    for (size_t i = 0; i < offer->mime_type_count; i++) {
+        if (strcmp(offer->mime_types[i], mime_type) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void offer_destroy(MW_DataOffer *offer) {
+    if (offer == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < offer->mime_type_count; i++) {
+        free(offer->mime_types[i]);
+    }
+    free(offer->mime_types);
+    wl_data_offer_destroy(offer->offer);
+    free(offer);
+}
+
+static MW_Error offer_receive(MW_DataOffer *offer, const char *mime_type, int fd) {
+    MW_CHECK_NONNULL(mime_type);
+    if (fd < 0 || !offer_has_mime_type(offer, mime_type)) {
+        return MW_INVALID_PARAM;
+    }
+
+    int pipe_fds[2];
+    if (pipe2(pipe_fds, O_CLOEXEC | O_NONBLOCK) == -1) {
+        return MW_FAILED_PIPE_CREATION;
+    }
+
+    if (transfer_add(pipe_fds[0], fd, fd, NULL) == NULL) {
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        return MW_OUT_OF_MEMORY;
+    }
+
+    // The write end is duplicated when the request is sent, so our copy has to be closed right away.
+    // Otherwise the transfer would never see the end of the data.
+    wl_data_offer_receive(offer->offer, mime_type, pipe_fds[1]);
+    wl_display_flush(state.display);
+    close(pipe_fds[1]);
+
+    return MW_SUCCESS;
+}
+
+static void data_offer_offer(void *data, __attribute__((unused))struct wl_data_offer *wl_data_offer,
+        const char *mime_type) {
+    MW_DataOffer *offer = (MW_DataOffer *) data;
+
+    char **mime_types = realloc(offer->mime_types, (offer->mime_type_count + 1) * sizeof(char *));
+    if (mime_types == NULL) {
+        return;
+    }
+    offer->mime_types = mime_types;
+
+    char *copy = strdup(mime_type);
+    if (copy == NULL) {
+        return;
+    }
+    offer->mime_types[offer->mime_type_count++] = copy;
+}
+
+static const struct wl_data_offer_listener data_offer_listener = {
+    .offer = data_offer_offer
+};
+
+
+// Sources
+
+// Frees the source once it has been destroyed and none of its transfers are running anymore
+static void source_free_unused(MW_DataSource *source) {
+    if (source->source == NULL && source->transfer_count == 0) {
+        close(source->fd);
+        free(source);
+    }
+}
+
+static void source_release(MW_DataSource *source) {
+    source->transfer_count--;
+    source_free_unused(source);
+}
+
+static void source_destroy(MW_DataSource *source) {
+    if (source == NULL) {
+        return;
+    }
+    wl_data_source_destroy(source->source);
+    source->source = NULL;
+    source_free_unused(source);
+}
+
+static void data_source_target(
+        __attribute__((unused))void *data,
+        __attribute__((unused))struct wl_data_source *wl_data_source,
+        __attribute__((unused))const char *mime_type) {
+}
+
+static void data_source_send(void *data, __attribute__((unused))struct wl_data_source *wl_data_source,
+        __attribute__((unused))const char *mime_type, int32_t fd) {
+    MW_DataSource *source = (MW_DataSource *) data;
+
+    // Every send reads the file through its own descriptor and offset, so multiple pastes can run at the same time
+    int in_fd = fcntl(source->fd, F_DUPFD_CLOEXEC, 0);
+    if (in_fd == -1) {
+        close(fd);
+        return;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    if (transfer_add(in_fd, fd, source->fd, source) == NULL) {
+        close(in_fd);
+        close(fd);
+    }
+}
+
+static void data_source_cancelled(void *data, __attribute__((unused))struct wl_data_source *wl_data_source) {
+    MW_DataSource *source = (MW_DataSource *) data;
+    if (state.selection_source == source) {
+        state.selection_source = NULL;
+    }
+    if (state.drag_source == source) {
+        state.drag_source = NULL;
+    }
+    source_destroy(source);
+}
+
+static const struct wl_data_source_listener data_source_listener = {
+    .target = data_source_target,
+    .send = data_source_send,
+    .cancelled = data_source_cancelled
+};
+
+static MW_Error source_create(MW_DataSource **source, const char *const *mime_types, size_t mime_type_count, int fd) {
+    MW_CHECK_NONNULL(mime_types);
+    if (mime_type_count == 0 || fd < 0 || lseek(fd, 0, SEEK_CUR) == -1) {
+        return MW_INVALID_PARAM;
+    }
+    for (size_t i = 0; i < mime_type_count; i++) {
+        MW_CHECK_NONNULL(mime_types[i]);
+    }
+
+    *source = malloc(sizeof(MW_DataSource));
+    if (*source == NULL) {
+        return MW_OUT_OF_MEMORY;
+    }
+
+    (*source)->fd = fd;
+    (*source)->transfer_count = 0;
+    (*source)->source = wl_data_device_manager_create_data_source(state.data_device_manager);
+    wl_data_source_add_listener((*source)->source, &data_source_listener, (void *) *source);
+    for (size_t i = 0; i < mime_type_count; i++) {
+        wl_data_source_offer((*source)->source, mime_types[i]);
+    }
+
+    return MW_SUCCESS;
+}
+
+
+// Wayland data device event listeners
+
+static void data_device_data_offer(
+        __attribute__((unused))void *data,
+        __attribute__((unused))struct wl_data_device *wl_data_device,
+        struct wl_data_offer *wl_data_offer) {
+    MW_DataOffer *offer = calloc(1, sizeof(MW_DataOffer));
+    if (offer == NULL) {
+        wl_data_offer_destroy(wl_data_offer);
+        return;
+    }
+    offer->offer = wl_data_offer;
+    wl_data_offer_add_listener(wl_data_offer, &data_offer_listener, (void *) offer);
+}
+
+static void data_device_enter(
+        __attribute__((unused))void *data,
+        __attribute__((unused))struct wl_data_device *wl_data_device,
+        uint32_t serial, struct wl_surface *surface,
+        __attribute__((unused))wl_fixed_t x, __attribute__((unused))wl_fixed_t y,
+        struct wl_data_offer *wl_data_offer) {
+    offer_destroy(state.drag_offer);
+    state.drag_offer = wl_data_offer != NULL ? (MW_DataOffer *) wl_data_offer_get_user_data(wl_data_offer) : NULL;
+    state.drag_focus = surface != NULL ? (MW_Window *) wl_surface_get_user_data(surface) : NULL;
+
+    if (state.drag_offer == NULL) {
+        return;
+    }
+
+    const char *accepted = NULL;
+    if (state.drag_focus != NULL && state.drag_focus->drop_cb != NULL && state.drag_offer->mime_type_count > 0) {
+        accepted = state.drag_offer->mime_types[0];
+    }
+    wl_data_offer_accept(state.drag_offer->offer, serial, accepted);
+}
+
+static void data_device_leave(
+        __attribute__((unused))void *data,
+        __attribute__((unused))struct wl_data_device *wl_data_device) {
+    offer_destroy(state.drag_offer);
+    state.drag_offer = NULL;
+    state.drag_focus = NULL;
+}
+
+static void data_device_motion(
+        __attribute__((unused))void *data,
+        __attribute__((unused))struct wl_data_device *wl_data_device,
+        __attribute__((unused))uint32_t time,
+        __attribute__((unused))wl_fixed_t x,
+        __attribute__((unused))wl_fixed_t y) {
+}
+
+static void data_device_drop(
+        __attribute__((unused))void *data,
+        __attribute__((unused))struct wl_data_device *wl_data_device) {
+    if (state.drag_offer != NULL && state.drag_focus != NULL && state.drag_focus->drop_cb != NULL) {
+        state.dropping = true;
+        state.drag_focus->drop_cb((const char *const *) state.drag_offer->mime_types, state.drag_offer->mime_type_count);
+        state.dropping = false;
+    }
+
+    // Transfers started from the drop callback keep their own pipes, so the offer is not needed anymore
+    offer_destroy(state.drag_offer);
+    state.drag_offer = NULL;
+    state.drag_focus = NULL;
+}
+
+static void data_device_selection(
+        __attribute__((unused))void *data,
+        __attribute__((unused))struct wl_data_device *wl_data_device,
+        struct wl_data_offer *wl_data_offer) {
+    offer_destroy(state.selection_offer);
+    state.selection_offer = wl_data_offer != NULL ? (MW_DataOffer *) wl_data_offer_get_user_data(wl_data_offer) : NULL;
+}
+
+static const struct wl_data_device_listener data_device_listener = {
+    .data_offer = data_device_data_offer,
+    .enter = data_device_enter,
+    .leave = data_device_leave,
+    .motion = data_device_motion,
+    .drop = data_device_drop,
+    .selection = data_device_selection
+};
+
+void MW_data_device_setup() {
+    if (state.data_device == NULL && state.data_device_manager != NULL && state.seat != NULL) {
+        state.data_device = wl_data_device_manager_get_data_device(state.data_device_manager, state.seat);
+        wl_data_device_add_listener(state.data_device, &data_device_listener, NULL);
+    }
+}
+
+
+MW_Error MW_set_transfer_callback(MW_transfer_cb callback) {
+    MW_CHECK_INITIALISED();
+    state.transfer_cb = callback;
+    return MW_SUCCESS;
+}
+
+MW_Error MW_clipboard_get_mime_types(const char *const **mime_types, size_t *mime_type_count) {
+    MW_CHECK_INITIALISED();
+    MW_CHECK_NONNULL(mime_types);
+    MW_CHECK_NONNULL(mime_type_count);
+
+    if (state.data_device == NULL) {
+        return MW_NO_DATA_DEVICE;
+    }
+    if (state.selection_offer == NULL) {
+        return MW_NO_DATA_OFFER;
+    }
+
+    *mime_types = (const char *const *) state.selection_offer->mime_types;
+    *mime_type_count = state.selection_offer->mime_type_count;
+    return MW_SUCCESS;
+}
+
+MW_Error MW_clipboard_receive(const char *mime_type, int fd) {
+    MW_CHECK_INITIALISED();
+
+    if (state.data_device == NULL) {
+        return MW_NO_DATA_DEVICE;
+    }
+    if (state.selection_offer == NULL) {
+        return MW_NO_DATA_OFFER;
+    }
+
+    return offer_receive(state.selection_offer, mime_type, fd);
+}
+
+MW_Error MW_clipboard_offer(const char *const *mime_types, size_t mime_type_count, int fd) {
+    MW_CHECK_INITIALISED();
+
+    if (state.data_device == NULL) {
+        return MW_NO_DATA_DEVICE;
+    }
+
+    MW_DataSource *source;
+    MW_Error status = source_create(&source, mime_types, mime_type_count, fd);
+    if (status != MW_SUCCESS) {
+        return status;
+    }
+
+    // The previous source is freed once the compositor cancels it
+    state.selection_source = source;
+    wl_data_device_set_selection(state.data_device, source->source, state.input_serial);
+    return MW_SUCCESS;
+}
+
+MW_Error MW_Window_set_drop_callback(MW_Window *window, MW_Window_drop_cb callback) {
+    MW_CHECK_INITIALISED();
+    MW_CHECK_WINDOW_NONNULL(window);
+    window->drop_cb = callback;
+    return MW_SUCCESS;
+}
+
+MW_Error MW_drop_receive(const char *mime_type, int fd) {
+    MW_CHECK_INITIALISED();
+
+    if (!state.dropping || state.drag_offer == NULL) {
+        return MW_NO_DATA_OFFER;
+    }
+
+    return offer_receive(state.drag_offer, mime_type, fd);
+}
+
+MW_Error MW_Window_start_drag(MW_Window *window, const char *const *mime_types, size_t mime_type_count, int fd) {
+    MW_CHECK_INITIALISED();
+    MW_CHECK_WINDOW_NONNULL(window);
+
+    if (state.data_device == NULL) {
+        return MW_NO_DATA_DEVICE;
+    }
+
+    MW_DataSource *source;
+    MW_Error status = source_create(&source, mime_types, mime_type_count, fd);
+    if (status != MW_SUCCESS) {
+        return status;
+    }
+
+    source_destroy(state.drag_source);
+    state.drag_source = source;
+    wl_data_device_start_drag(state.data_device, source->source, window->wayland_surface, NULL, state.input_serial);
+    return MW_SUCCESS;
+}
+
+void MW_data_device_cleanup() {
+    // Closing the transfers releases the sources they send from, which are freed below (or already have been)
+    while (state.transfers != NULL) {
+        MW_Transfer *transfer = state.transfers;
+        state.transfers = transfer->next;
+        transfer_close(transfer);
+    }
+
+    offer_destroy(state.selection_offer);
+    offer_destroy(state.drag_offer);
+    source_destroy(state.selection_source);
+    source_destroy(state.drag_source);
+
+    if (state.data_device != NULL) {
+        wl_data_device_destroy(state.data_device);
+    }
+    if (state.data_device_manager != NULL) {
+        wl_data_device_manager_destroy(state.data_device_manager);
+    }
+}
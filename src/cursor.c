@@ -0,0 +1,248 @@
+#include "../include/uwindow.h"
+#include "internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_CURSOR_SIZE 24
+
+
+// Cursor animation
+
+static void cursor_frame_done(void *data, struct wl_callback *callback, uint32_t time);
+
+static const struct wl_callback_listener cursor_frame_listener = {
+    .done = cursor_frame_done
+};
+
+static void cursor_request_frame() {
+    if (state.cursor_frame_callback == NULL) {
+        state.cursor_frame_callback = wl_surface_frame(state.cursor_surface);
+        wl_callback_add_listener(state.cursor_frame_callback, &cursor_frame_listener, NULL);
+    }
+}
+
+static void cursor_show_image(struct wl_cursor_image *image) {
+    struct wl_buffer *buffer = wl_cursor_image_get_buffer(image);
+    if (buffer == NULL) {
+        return;
+    }
+
+    // The hotspot may differ between the frames of an animated cursor, so it is set again for every image
+    wl_pointer_set_cursor(state.pointer, state.pointer_enter_serial, state.cursor_surface,
+            image->hotspot_x, image->hotspot_y);
+    wl_surface_attach(state.cursor_surface, buffer, 0, 0);
+    wl_surface_damage(state.cursor_surface, 0, 0, image->width, image->height);
+    state.cursor_image = image;
+}
+
+static void cursor_frame_done(__attribute__((unused))void *data, struct wl_callback *callback, uint32_t time) {
+    wl_callback_destroy(callback);
+    state.cursor_frame_callback = NULL;
+
+    if (state.pointer_focus == NULL || state.cursor == NULL || state.cursor->image_count < 2) {
+        return;
+    }
+
+    if (!state.cursor_animation_started) {
+        state.cursor_animation_start = time;
+        state.cursor_animation_started = true;
+    }
+
+    struct wl_cursor_image *image = state.cursor->images[wl_cursor_frame(state.cursor, time - state.cursor_animation_start)];
+    if (image != state.cursor_image) {
+        cursor_show_image(image);
+    }
+
+    cursor_request_frame();
+    wl_surface_commit(state.cursor_surface);
+}
+
+void MW_cursor_update() {
+    if (state.pointer == NULL || state.pointer_focus == NULL || state.cursor_theme == NULL) {
+        return;
+    }
+
+    state.cursor = NULL;
+    state.cursor_image = NULL;
+    state.cursor_animation_started = false;
+
+    if (state.pointer_focus->cursor_name[0] != '\0') {
+        state.cursor = wl_cursor_theme_get_cursor(state.cursor_theme, state.pointer_focus->cursor_name);
+    }
+
+    if (state.cursor == NULL || state.cursor->image_count == 0) {
+        state.cursor = NULL;
+        wl_pointer_set_cursor(state.pointer, state.pointer_enter_serial, NULL, 0, 0);
+        return;
+    }
+
+    cursor_show_image(state.cursor->images[0]);
+    if (state.cursor->image_count > 1) {
+        cursor_request_frame();
+    }
+    wl_surface_commit(state.cursor_surface);
+}
+
+
+// Wayland seat and pointer event listeners
+
+static void pointer_enter(__attribute__((unused))void *data, __attribute__((unused))struct wl_pointer *pointer,
+        uint32_t serial, struct wl_surface *surface,
+        __attribute__((unused))wl_fixed_t x, __attribute__((unused))wl_fixed_t y) {
+    state.pointer_enter_serial = serial;
+    state.input_serial = serial;
+    state.pointer_focus = NULL;
+    if (surface != NULL && surface != state.cursor_surface) {
+        state.pointer_focus = (MW_Window *) wl_surface_get_user_data(surface);
+    }
+    MW_cursor_update();
+}
+
+static void pointer_leave(
+        __attribute__((unused))void *data,
+        __attribute__((unused))struct wl_pointer *pointer,
+        __attribute__((unused))uint32_t serial,
+        __attribute__((unused))struct wl_surface *surface) {
+    state.pointer_focus = NULL;
+    state.cursor = NULL;
+    state.cursor_image = NULL;
+}
+
+static void pointer_motion(
+        __attribute__((unused))void *data,
+        __attribute__((unused))struct wl_pointer *pointer,
+        __attribute__((unused))uint32_t time,
+        __attribute__((unused))wl_fixed_t x,
+        __attribute__((unused))wl_fixed_t y) {
+}
+
+static void pointer_button(
+        __attribute__((unused))void *data,
+        __attribute__((unused))struct wl_pointer *pointer,
+        uint32_t serial,
+        __attribute__((unused))uint32_t time,
+        __attribute__((unused))uint32_t button,
+        __attribute__((unused))uint32_t button_state) {
+    // Setting the clipboard and starting drags requires the serial of a recent input event
+    state.input_serial = serial;
+}
+
+static void pointer_axis(
+        __attribute__((unused))void *data,
+        __attribute__((unused))struct wl_pointer *pointer,
+        __attribute__((unused))uint32_t time,
+        __attribute__((unused))uint32_t axis,
+        __attribute__((unused))wl_fixed_t value) {
+}
+
+static const struct wl_pointer_listener pointer_listener = {
+    .enter = pointer_enter,
+    .leave = pointer_leave,
+    .motion = pointer_motion,
+    .button = pointer_button,
+    .axis = pointer_axis
+};
+
+static void seat_capabilities(__attribute__((unused))void *data, struct wl_seat *seat, uint32_t capabilities) {
+    bool has_pointer = (capabilities & WL_SEAT_CAPABILITY_POINTER) != 0;
+
+    if (has_pointer && state.pointer == NULL) {
+        state.pointer = wl_seat_get_pointer(seat);
+        wl_pointer_add_listener(state.pointer, &pointer_listener, NULL);
+    } else if (!has_pointer && state.pointer != NULL) {
+        wl_pointer_destroy(state.pointer);
+        state.pointer = NULL;
+        state.pointer_focus = NULL;
+        state.cursor = NULL;
+        state.cursor_image = NULL;
+    }
+}
+
+const struct wl_seat_listener MW_seat_listener = {
+    .capabilities = seat_capabilities
+};
+
+
+MW_Error MW_set_cursor_theme(const char *theme_name, int size) {
+    MW_CHECK_INITIALISED();
+
+    if (state.shm == NULL) {
+        return MW_FAILED_CURSOR_THEME_LOAD;
+    }
+
+    if (size <= 0) {
+        const char *size_env = getenv("XCURSOR_SIZE");
+        size = size_env != NULL ? atoi(size_env) : 0;
+        if (size <= 0) {
+            size = DEFAULT_CURSOR_SIZE;
+        }
+    }
+    if (theme_name == NULL) {
+        theme_name = getenv("XCURSOR_THEME");
+    }
+
+    struct wl_cursor_theme *theme = wl_cursor_theme_load(theme_name, size, state.shm);
+    if (theme == NULL) {
+        return MW_FAILED_CURSOR_THEME_LOAD;
+    }
+
+    if (state.cursor_surface == NULL) {
+        state.cursor_surface = wl_compositor_create_surface(state.compositor);
+    }
+
+    // Switch the cursor over to the new theme before destroying the old theme's buffers
+    struct wl_cursor_theme *old_theme = state.cursor_theme;
+    state.cursor_theme = theme;
+    MW_cursor_update();
+    if (old_theme != NULL) {
+        wl_cursor_theme_destroy(old_theme);
+    }
+
+    return MW_SUCCESS;
+}
+
+MW_Error MW_Window_set_cursor(MW_Window *window, const char *cursor_name) {
+    MW_CHECK_INITIALISED();
+    MW_CHECK_WINDOW_NONNULL(window);
+
+    if (cursor_name == NULL) {
+        window->cursor_name[0] = '\0';
+    } else {
+        if (strlen(cursor_name) >= MW_CURSOR_NAME_MAX) {
+            return MW_INVALID_PARAM;
+        }
+        if (state.cursor_theme == NULL) {
+            return MW_NO_CURSOR_THEME;
+        }
+        if (wl_cursor_theme_get_cursor(state.cursor_theme, cursor_name) == NULL) {
+            return MW_CURSOR_NOT_FOUND;
+        }
+        strcpy(window->cursor_name, cursor_name);
+    }
+
+    if (state.pointer_focus == window) {
+        MW_cursor_update();
+    }
+    return MW_SUCCESS;
+}
+
+void MW_cursor_cleanup() {
+    if (state.cursor_frame_callback != NULL) {
+        wl_callback_destroy(state.cursor_frame_callback);
+    }
+    if (state.cursor_surface != NULL) {
+        wl_surface_destroy(state.cursor_surface);
+    }
+    if (state.cursor_theme != NULL) {
+        wl_cursor_theme_destroy(state.cursor_theme);
+    }
+    if (state.pointer != NULL) {
+        wl_pointer_destroy(state.pointer);
+    }
+    if (state.seat != NULL) {
+        wl_seat_destroy(state.seat);
+    }
+    if (state.shm != NULL) {
+        wl_shm_destroy(state.shm);
+    }
+}
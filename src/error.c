@@ -38,6 +38,38 @@ const char *MW_get_error_string(MW_Error error_code) {
             return "Failed to dispatch events from wayland server event queue";
         case MW_FAILED_DISPLAY_FLUSH:
             return "Failed to flush display event queue";
+        case MW_NO_CURSOR_THEME:
+            return "No cursor theme is loaded";
+        case MW_FAILED_CURSOR_THEME_LOAD:
+            return "Failed to load the cursor theme";
+        case MW_CURSOR_NOT_FOUND:
+            return "The requested cursor does not exist in the loaded cursor theme";
+        case MW_OUT_OF_MEMORY:
+            return "Failed to allocate memory";
+        case MW_NO_DATA_DEVICE:
+            return "The compositor does not support the clipboard or drag and drop";
+        case MW_NO_DATA_OFFER:
+            return "There is no clipboard content or dropped data to receive";
+        case MW_FAILED_PIPE_CREATION:
+            return "Failed to create a pipe for a data transfer";
+        case MW_FAILED_TRANSFER:
+            return "A clipboard or drag and drop data transfer failed";
+        case MW_FAILED_EGL_CONTEXT_CREATION:
+            return "Failed to create an EGL context with the requested attributes";
+        case MW_NO_BLOB_CACHE_EXTENSION:
+            return "The EGL implementation does not support EGL_ANDROID_blob_cache";
+        case MW_SHADER_CACHE_ALREADY_ENABLED:
+            return "The shader cache has already been enabled";
+        case MW_FAILED_SHADER_CACHE_OPEN:
+            return "Failed to open or map the shader cache file";
+        case MW_NO_PRESENT_THREAD_SUPPORT:
+            return "The EGL implementation lacks the fence sync or surfaceless context extensions needed for a present thread";
+        case MW_PRESENT_THREAD_ALREADY_RUNNING:
+            return "The window already has a present thread";
+        case MW_PRESENT_THREAD_NOT_RUNNING:
+            return "The window has no present thread";
+        case MW_FAILED_THREAD_CREATION:
+            return "Failed to create the present thread";
         default:
             return "An unknown error occurred";
     }
@@ -3,23 +3,149 @@
 
 #include <stdbool.h>
 #include <wayland-client.h>
+#include <wayland-cursor.h>
 #include <EGL/egl.h>
 #include "xdg-shell-client-protocol.h"
+#include "../include/window.h"
+#include "../include/clipboard.h"
+
+// A clipboard or drag and drop offer made by another client, together with the MIME types it is offered in
+typedef struct {
+    struct wl_data_offer *offer;
+    char **mime_types;
+    size_t mime_type_count;
+} MW_DataOffer;
+
+// Data offered by us through the clipboard or a drag. The fd is owned by the source.
+// The wayland source is destroyed once it is replaced or cancelled, but the fd is kept open (and the struct allocated)
+// until the last transfer sending from it has finished, since that fd is what the transfer callback reports.
+typedef struct {
+    struct wl_data_source *source;
+    int fd;
+    size_t transfer_count;
+} MW_DataSource;
+
+// A data transfer in progress, streamed from in_fd to out_fd while events are processed
+typedef struct MW_Transfer {
+    struct MW_Transfer *next;
+    int in_fd;
+    int out_fd;
+    // The fd reported to the user once the transfer has finished
+    int user_fd;
+    // Sending transfers read from the user's (seekable) file at offset and own both fds,
+    // receiving transfers own only their pipe (in_fd) and write to the user's fd
+    bool sending;
+    // The source a sending transfer reads from (NULL for receiving transfers)
+    MW_DataSource *source;
+    // Set when the last chunk could not be moved because out_fd was full, so that waiting polls out_fd instead of in_fd
+    bool output_blocked;
+    long long offset;
+    // Data a receiving transfer has already taken out of its pipe, but could not write to the full out_fd yet.
+    // Allocated with the size of one chunk once the transfer falls back to read/write.
+    char *pending;
+    size_t pending_offset;
+    size_t pending_size;
+    // Set once splice has refused the pair of fds and the transfer falls back to read/write
+    bool no_splice;
+} MW_Transfer;
 
 // An internal struct to hold the libraries state across translation units
 typedef struct {
     bool initialised;
     struct wl_display *display;
     EGLDisplay *egl_display;
+    // The config used for opaque windows has no alpha channel, the one for translucent windows has one
     EGLConfig egl_config;
+    EGLConfig egl_config_alpha;
+    bool has_egl_config_alpha;
     struct wl_registry *registry;
     struct wl_compositor *compositor;
     struct xdg_wm_base *wm_base;
+
+    // Pointer input and cursor state (see cursor.c)
+    struct wl_shm *shm;
+    struct wl_seat *seat;
+    struct wl_pointer *pointer;
+    uint32_t pointer_enter_serial;
+    MW_Window *pointer_focus;
+    struct wl_cursor_theme *cursor_theme;
+    struct wl_surface *cursor_surface;
+    struct wl_callback *cursor_frame_callback;
+    struct wl_cursor *cursor;
+    struct wl_cursor_image *cursor_image;
+    bool cursor_animation_started;
+    uint32_t cursor_animation_start;
+
+    // Clipboard and drag and drop state (see clipboard.c)
+    struct wl_data_device_manager *data_device_manager;
+    struct wl_data_device *data_device;
+    uint32_t input_serial;
+    MW_DataOffer *selection_offer;
+    MW_DataOffer *drag_offer;
+    MW_Window *drag_focus;
+    bool dropping;
+    MW_DataSource *selection_source;
+    MW_DataSource *drag_source;
+    MW_Transfer *transfers;
+    MW_transfer_cb transfer_cb;
+
+    // The memory-mapped shader cache file (see shader_cache.c)
+    int shader_cache_fd;
+    unsigned char *shader_cache;
+    size_t shader_cache_size;
 } MW_LibState;
 
-// A singleton global object that will be initalised in uwindow.c and used by uwindow.c and window.c
+// A singleton global object that will be initalised in uwindow.c and used by all other translation units
 extern MW_LibState state;
 
+// The seat listener lives in cursor.c, but the seat is bound in the registry handler in uwindow.c
+extern const struct wl_seat_listener MW_seat_listener;
+
+// Shows the cursor of the window the pointer is currently in (or does nothing if the pointer is in no window)
+void MW_cursor_update();
+
+// Frees all pointer and cursor related objects, called by MW_finish()
+void MW_cursor_cleanup();
+
+// Creates the data device once both the seat and the data device manager have been bound
+void MW_data_device_setup();
+
+// Moves as much data as possible for all transfers without blocking
+void MW_transfers_process();
+
+// Blocks until either wayland events or transfer data is available and reads the wayland events
+MW_Error MW_transfers_wait();
+
+// Aborts all transfers and frees all clipboard and drag and drop objects, called by MW_finish()
+void MW_data_device_cleanup();
+
+// Unmaps and closes the shader cache file, called by MW_finish()
+void MW_shader_cache_cleanup();
+
+// Whether the EGL display supports an extension, since extension names may be prefixes of each other
+bool MW_has_egl_extension(const char *name);
+
+// Whether a swap of the window would never be shown and should be skipped, since the window is suspended and
+// skip_suspended_frames is set
+bool MW_window_skips_frame(const MW_Window *window);
+
+// Hands the frame rendered by the application over to the window's present thread (see present_thread.c)
+MW_Error MW_present_thread_submit(MW_Window *window);
+
+// Makes the window's context current without a surface, since the surface is current on the present thread
+MW_Error MW_present_thread_make_current(MW_Window *window);
+
+// Lock the mutex of the window's present thread (or do nothing if the window has none). It has to be held while the
+// window's callbacks and skip_suspended_frames are set, and while the present thread reads them.
+void MW_present_thread_lock(MW_Window *window);
+void MW_present_thread_unlock(MW_Window *window);
+
+// The window's states as last seen by the present thread, which handles the window's events
+uint32_t MW_present_thread_get_states(MW_Window *window);
+
+// Stops the present thread and hands the window's surface and events back to the calling thread
+void MW_present_thread_stop(MW_Window *window);
+
 // Internal compiler macros for function argument checking
 #define MW_CHECK_NONNULL(p) if (p == NULL) return MW_INVALID_PARAM;
 #define MW_CHECK_WINDOW_NONNULL(w) if ( \
@@ -0,0 +1,602 @@
+// poll() and eventfd() are not part of C17
+#define _GNU_SOURCE
+
+#include "../include/uwindow.h"
+#include "internal.h"
+#include <EGL/eglext.h>
+#include <GL/gl.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+
+typedef enum {
+    // Can be handed to the application by MW_Window_begin_frame
+    SLOT_FREE,
+    // Handed to the application, which is rendering into it
+    SLOT_RENDERING,
+    // Handed over by MW_Window_swap_buffers, waiting for the present thread
+    SLOT_QUEUED,
+    // Being copied into the window by the present thread
+    SLOT_PRESENTING
+} SlotState;
+
+// One of the offscreen framebuffers the application renders into
+typedef struct {
+    SlotState state;
+    // The order in which queued slots were handed over, so that frames are presented in order
+    uint64_t sequence;
+    int32_t width;
+    int32_t height;
+    // Textures and renderbuffers are shared between the contexts, framebuffers are not.
+    // The framebuffer belongs to the application's context, the read framebuffer to the present thread's context.
+    GLuint texture;
+    GLuint depth_stencil;
+    GLuint framebuffer;
+    GLuint read_framebuffer;
+    // Signalled once the application's rendering into the slot has finished on the GPU
+    EGLSyncKHR render_fence;
+    // Signalled once the present thread's copy out of the slot has finished on the GPU
+    EGLSyncKHR release_fence;
+} PresentSlot;
+
+struct MW_PresentThread {
+    pthread_t thread;
+    // Protects the slot states, the window size and states, stopping and error, as well as the window's callbacks and
+    // skip_suspended_frames, which are set by the application and used by the present thread
+    pthread_mutex_t mutex;
+    pthread_cond_t slot_freed;
+    // An eventfd which wakes the present thread up from waiting for wayland events
+    int wake_fd;
+    // The window's wayland objects are moved to this queue, which is only dispatched by the present thread
+    struct wl_event_queue *queue;
+    // The present thread waits for the compositor with frame callbacks instead of inside eglSwapBuffers,
+    // so that it keeps handling events and can be stopped while the compositor throttles the window
+    struct wl_callback *frame_callback;
+    EGLContext context;
+    PresentSlot slots[MW_PRESENT_MAX_BUFFERS];
+    unsigned int slot_count;
+    // The slot the application is rendering into (or -1), only used by the application's thread
+    int rendering_slot;
+    uint64_t next_sequence;
+    // Copies of the window's size and states, which are changed by the event handlers on the present thread
+    int32_t width;
+    int32_t height;
+    uint32_t states;
+    bool stopping;
+    // The error that stopped the present thread
+    MW_Error error;
+};
+
+// The functions are looked up once, EGL returns the same pointers for all contexts
+static struct {
+    bool loaded;
+    PFNEGLCREATESYNCKHRPROC create_sync;
+    PFNEGLDESTROYSYNCKHRPROC destroy_sync;
+    PFNEGLWAITSYNCKHRPROC wait_sync;
+    PFNGLGENFRAMEBUFFERSPROC gen_framebuffers;
+    PFNGLDELETEFRAMEBUFFERSPROC delete_framebuffers;
+    PFNGLBINDFRAMEBUFFERPROC bind_framebuffer;
+    PFNGLFRAMEBUFFERTEXTURE2DPROC framebuffer_texture_2d;
+    PFNGLFRAMEBUFFERRENDERBUFFERPROC framebuffer_renderbuffer;
+    PFNGLGENRENDERBUFFERSPROC gen_renderbuffers;
+    PFNGLDELETERENDERBUFFERSPROC delete_renderbuffers;
+    PFNGLBINDRENDERBUFFERPROC bind_renderbuffer;
+    PFNGLRENDERBUFFERSTORAGEPROC renderbuffer_storage;
+    PFNGLBLITFRAMEBUFFERPROC blit_framebuffer;
+} procs;
+
+static bool load_procs() {
+    if (procs.loaded) {
+        return true;
+    }
+    if (!MW_has_egl_extension("EGL_KHR_fence_sync") ||
+            !MW_has_egl_extension("EGL_KHR_wait_sync") ||
+            !MW_has_egl_extension("EGL_KHR_surfaceless_context")) {
+        return false;
+    }
+
+    procs.create_sync = (PFNEGLCREATESYNCKHRPROC) eglGetProcAddress("eglCreateSyncKHR");
+    procs.destroy_sync = (PFNEGLDESTROYSYNCKHRPROC) eglGetProcAddress("eglDestroySyncKHR");
+    procs.wait_sync = (PFNEGLWAITSYNCKHRPROC) eglGetProcAddress("eglWaitSyncKHR");
+    procs.gen_framebuffers = (PFNGLGENFRAMEBUFFERSPROC) eglGetProcAddress("glGenFramebuffers");
+    procs.delete_framebuffers = (PFNGLDELETEFRAMEBUFFERSPROC) eglGetProcAddress("glDeleteFramebuffers");
+    procs.bind_framebuffer = (PFNGLBINDFRAMEBUFFERPROC) eglGetProcAddress("glBindFramebuffer");
+    procs.framebuffer_texture_2d = (PFNGLFRAMEBUFFERTEXTURE2DPROC) eglGetProcAddress("glFramebufferTexture2D");
+    procs.framebuffer_renderbuffer = (PFNGLFRAMEBUFFERRENDERBUFFERPROC) eglGetProcAddress("glFramebufferRenderbuffer");
+    procs.gen_renderbuffers = (PFNGLGENRENDERBUFFERSPROC) eglGetProcAddress("glGenRenderbuffers");
+    procs.delete_renderbuffers = (PFNGLDELETERENDERBUFFERSPROC) eglGetProcAddress("glDeleteRenderbuffers");
+    procs.bind_renderbuffer = (PFNGLBINDRENDERBUFFERPROC) eglGetProcAddress("glBindRenderbuffer");
+    procs.renderbuffer_storage = (PFNGLRENDERBUFFERSTORAGEPROC) eglGetProcAddress("glRenderbufferStorage");
+    procs.blit_framebuffer = (PFNGLBLITFRAMEBUFFERPROC) eglGetProcAddress("glBlitFramebuffer");
+
+    procs.loaded = procs.create_sync != NULL && procs.destroy_sync != NULL && procs.wait_sync != NULL &&
+        procs.gen_framebuffers != NULL && procs.delete_framebuffers != NULL && procs.bind_framebuffer != NULL &&
+        procs.framebuffer_texture_2d != NULL && procs.framebuffer_renderbuffer != NULL &&
+        procs.gen_renderbuffers != NULL && procs.delete_renderbuffers != NULL && procs.bind_renderbuffer != NULL &&
+        procs.renderbuffer_storage != NULL && procs.blit_framebuffer != NULL;
+    return procs.loaded;
+}
+
+// Makes the GPU (but not the calling thread) wait for a fence before running further commands, then frees the fence
+static void fence_wait(EGLSyncKHR *fence) {
+    if (*fence != NULL) {
+        procs.wait_sync(state.egl_display, *fence, 0);
+        procs.destroy_sync(state.egl_display, *fence);
+        *fence = NULL;
+    }
+}
+
+static void present_thread_wake(struct MW_PresentThread *present) {
+    uint64_t value = 1;
+    while (write(present->wake_fd, &value, sizeof(value)) == -1 && errno == EINTR) {
+    }
+}
+
+
+// The present thread
+
+static void present_frame_done(void *data, struct wl_callback *callback, __attribute__((unused))uint32_t time) {
+    struct MW_PresentThread *present = (struct MW_PresentThread *) data;
+    wl_callback_destroy(callback);
+    present->frame_callback = NULL;
+}
+
+static const struct wl_callback_listener present_frame_listener = {
+    .done = present_frame_done
+};
+
+// Copies the frame in the slot into the window and swaps the window's buffers, or only releases the slot if skip is set
+static MW_Error present_slot(MW_Window *window, PresentSlot *slot, bool skip) {
+    fence_wait(&slot->render_fence);
+
+    MW_Error status = MW_SUCCESS;
+    if (skip) {
+        glFlush();
+    } else {
+        // The texture has to be attached again every time, since the application may have reallocated it
+        procs.bind_framebuffer(GL_READ_FRAMEBUFFER, slot->read_framebuffer);
+        procs.framebuffer_texture_2d(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, slot->texture, 0);
+        procs.bind_framebuffer(GL_DRAW_FRAMEBUFFER, 0);
+
+        // A frame rendered before the window was resized is scaled to the new size
+        bool same_size = slot->width == window->current_width && slot->height == window->current_height;
+        procs.blit_framebuffer(0, 0, slot->width, slot->height, 0, 0, window->current_width, window->current_height,
+                GL_COLOR_BUFFER_BIT, same_size ? GL_NEAREST : GL_LINEAR);
+
+        // The callback of this request is what the thread waits for before presenting the next frame. It is requested on the
+        // thread's queue, which the surface has been moved to, so the thread receives it when reading its own events.
+        // While the window is suspended the thread keeps presenting without an answer, so an older request is kept.
+        struct MW_PresentThread *present = window->present_thread;
+        if (present->frame_callback == NULL) {
+            present->frame_callback = wl_surface_frame(window->wayland_surface);
+            wl_callback_add_listener(present->frame_callback, &present_frame_listener, (void *) present);
+        }
+
+        // The fence is flushed by the swap, which is required before another context can wait for it
+        slot->release_fence = procs.create_sync(state.egl_display, EGL_SYNC_FENCE_KHR, NULL);
+        if (eglSwapBuffers(state.egl_display, window->egl_surface) == EGL_FALSE) {
+            status = MW_FAILED_TO_SWAP_EGL_BUFFERS;
+        }
+    }
+
+    pthread_mutex_lock(&window->present_thread->mutex);
+    slot->state = SLOT_FREE;
+    pthread_cond_signal(&window->present_thread->slot_freed);
+    pthread_mutex_unlock(&window->present_thread->mutex);
+    return status;
+}
+
+// Blocks until either wayland events for the window have been read or the present thread has been woken up
+static MW_Error present_wait(struct MW_PresentThread *present) {
+    while (wl_display_prepare_read_queue(state.display, present->queue) != 0) {
+        if (wl_display_dispatch_queue_pending(state.display, present->queue) == -1) {
+            return MW_FAILED_DISPLAY_DISPATCH;
+        }
+    }
+    // Requests sent by the event handlers have to reach the compositor before waiting for its answer
+    wl_display_flush(state.display);
+
+    struct pollfd fds[2] = {
+        { .fd = wl_display_get_fd(state.display), .events = POLLIN },
+        { .fd = present->wake_fd, .events = POLLIN }
+    };
+    while (poll(fds, 2, -1) == -1) {
+        if (errno != EINTR) {
+            wl_display_cancel_read(state.display);
+            return MW_FAILED_DISPLAY_DISPATCH;
+        }
+    }
+
+    if (fds[0].revents & POLLIN) {
+        if (wl_display_read_events(state.display) == -1) {
+            return MW_FAILED_DISPLAY_DISPATCH;
+        }
+    } else {
+        wl_display_cancel_read(state.display);
+    }
+    if (fds[1].revents & POLLIN) {
+        uint64_t value;
+        while (read(present->wake_fd, &value, sizeof(value)) == -1 && errno == EINTR) {
+        }
+    }
+    return MW_SUCCESS;
+}
+
+static MW_Error present_loop(MW_Window *window) {
+    struct MW_PresentThread *present = window->present_thread;
+
+    while (true) {
+        if (wl_display_dispatch_queue_pending(state.display, present->queue) == -1) {
+            return MW_FAILED_DISPLAY_DISPATCH;
+        }
+
+        pthread_mutex_lock(&present->mutex);
+        present->width = window->current_width;
+        present->height = window->current_height;
+        present->states = window->states;
+
+        // A queued frame of a suspended window is taken right away instead of blocking the thread on a callback that
+        // only arrives once the window is shown again, and then either dropped or presented
+        bool stopping = present->stopping;
+        bool throttled = present->frame_callback != NULL && !(window->states & MW_WINDOW_STATE_SUSPENDED);
+        bool skip = MW_window_skips_frame(window);
+        PresentSlot *next = NULL;
+        for (unsigned int i = 0; i < present->slot_count && !stopping && !throttled; i++) {
+            PresentSlot *slot = &present->slots[i];
+            if (slot->state == SLOT_QUEUED && (next == NULL || slot->sequence < next->sequence)) {
+                next = slot;
+            }
+        }
+        if (next != NULL) {
+            next->state = SLOT_PRESENTING;
+        }
+        pthread_mutex_unlock(&present->mutex);
+
+        if (stopping) {
+            return MW_SUCCESS;
+        }
+
+        MW_Error status = next != NULL ? present_slot(window, next, skip) : present_wait(present);
+        if (status != MW_SUCCESS) {
+            return status;
+        }
+    }
+}
+
+static void *present_thread_main(void *data) {
+    MW_Window *window = (MW_Window *) data;
+    struct MW_PresentThread *present = window->present_thread;
+
+    // The bound API is per thread, so it has to be bound again on the new thread
+    MW_Error status = MW_SUCCESS;
+    if (eglBindAPI(EGL_OPENGL_API) == EGL_FALSE) {
+        status = MW_FAILED_OPENGL_API_BIND;
+    } else if (eglMakeCurrent(state.egl_display, window->egl_surface, window->egl_surface, present->context) == EGL_FALSE) {
+        status = MW_FAILED_TO_MAKE_EGL_CONTEXT_CURRENT;
+    } else {
+        eglSwapInterval(state.egl_display, 0);
+        for (unsigned int i = 0; i < present->slot_count; i++) {
+            procs.gen_framebuffers(1, &present->slots[i].read_framebuffer);
+        }
+
+        status = present_loop(window);
+
+        for (unsigned int i = 0; i < present->slot_count; i++) {
+            procs.delete_framebuffers(1, &present->slots[i].read_framebuffer);
+        }
+        if (present->frame_callback != NULL) {
+            wl_callback_destroy(present->frame_callback);
+            present->frame_callback = NULL;
+        }
+        eglMakeCurrent(state.egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+
+    // Wakes up the application if it is waiting for a slot that will never be freed
+    pthread_mutex_lock(&present->mutex);
+    present->error = status;
+    pthread_cond_broadcast(&present->slot_freed);
+    pthread_mutex_unlock(&present->mutex);
+    return NULL;
+}
+
+
+// The application's side
+
+// (Re)allocates the framebuffer of a slot in the application's context, keeping the application's bindings intact
+static void slot_resize(PresentSlot *slot, int32_t width, int32_t height) {
+    GLint previous_texture;
+    GLint previous_renderbuffer;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous_texture);
+    glGetIntegerv(GL_RENDERBUFFER_BINDING, &previous_renderbuffer);
+
+    if (slot->framebuffer == 0) {
+        glGenTextures(1, &slot->texture);
+        procs.gen_renderbuffers(1, &slot->depth_stencil);
+        procs.gen_framebuffers(1, &slot->framebuffer);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, slot->texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    procs.bind_renderbuffer(GL_RENDERBUFFER, slot->depth_stencil);
+    procs.renderbuffer_storage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+    procs.bind_framebuffer(GL_FRAMEBUFFER, slot->framebuffer);
+    procs.framebuffer_texture_2d(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, slot->texture, 0);
+    procs.framebuffer_renderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, slot->depth_stencil);
+
+    glBindTexture(GL_TEXTURE_2D, previous_texture);
+    procs.bind_renderbuffer(GL_RENDERBUFFER, previous_renderbuffer);
+    slot->width = width;
+    slot->height = height;
+}
+
+// Frees everything but the thread itself, which has to have exited (or never been started)
+static void present_thread_free(MW_Window *window, struct MW_PresentThread *present) {
+    if (present->queue != NULL) {
+        // Events that have already been read into the thread's queue are still dispatched from it
+        wl_proxy_set_queue((struct wl_proxy *) window->wayland_surface, NULL);
+        wl_proxy_set_queue((struct wl_proxy *) window->xdg_surface, NULL);
+        wl_proxy_set_queue((struct wl_proxy *) window->xdg_toplevel, NULL);
+        wl_display_dispatch_queue_pending(state.display, present->queue);
+        wl_event_queue_destroy(present->queue);
+    }
+
+    // The slots' objects belong to the application's context, which is current without a surface while the thread runs
+    for (unsigned int i = 0; i < present->slot_count; i++) {
+        PresentSlot *slot = &present->slots[i];
+        if (slot->framebuffer != 0 &&
+                eglMakeCurrent(state.egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, window->egl_context) == EGL_TRUE) {
+            procs.delete_framebuffers(1, &slot->framebuffer);
+            procs.delete_renderbuffers(1, &slot->depth_stencil);
+            glDeleteTextures(1, &slot->texture);
+        }
+        if (slot->render_fence != NULL) {
+            procs.destroy_sync(state.egl_display, slot->render_fence);
+        }
+        if (slot->release_fence != NULL) {
+            procs.destroy_sync(state.egl_display, slot->release_fence);
+        }
+    }
+
+    if (present->context != NULL) {
+        eglDestroyContext(state.egl_display, present->context);
+    }
+    if (present->wake_fd != -1) {
+        close(present->wake_fd);
+    }
+    pthread_cond_destroy(&present->slot_freed);
+    pthread_mutex_destroy(&present->mutex);
+    free(present);
+}
+
+MW_Error MW_Window_start_present_thread(MW_Window *window, unsigned int buffer_count) {
+    MW_CHECK_INITIALISED();
+    MW_CHECK_WINDOW_NONNULL(window);
+
+    if (buffer_count == 0 || buffer_count > MW_PRESENT_MAX_BUFFERS) {
+        return MW_INVALID_PARAM;
+    }
+    if (window->present_thread != NULL) {
+        return MW_PRESENT_THREAD_ALREADY_RUNNING;
+    }
+    if (!load_procs()) {
+        return MW_NO_PRESENT_THREAD_SUPPORT;
+    }
+
+    struct MW_PresentThread *present = calloc(1, sizeof(struct MW_PresentThread));
+    if (present == NULL) {
+        return MW_OUT_OF_MEMORY;
+    }
+    pthread_mutex_init(&present->mutex, NULL);
+    pthread_cond_init(&present->slot_freed, NULL);
+    present->wake_fd = -1;
+    present->slot_count = buffer_count;
+    present->rendering_slot = -1;
+    present->error = MW_SUCCESS;
+
+    if (eglBindAPI(EGL_OPENGL_API) == EGL_FALSE) {
+        present_thread_free(window, present);
+        return MW_FAILED_OPENGL_API_BIND;
+    }
+    present->context = eglCreateContext(state.egl_display, window->egl_config, window->egl_context, NULL);
+    if (present->context == EGL_NO_CONTEXT) {
+        present->context = NULL;
+        present_thread_free(window, present);
+        return MW_FAILED_EGL_CONTEXT_CREATION;
+    }
+
+    present->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (present->wake_fd == -1) {
+        present_thread_free(window, present);
+        return MW_FAILED_THREAD_CREATION;
+    }
+
+    // A surface can only be current on one thread, so the application keeps its context without the surface
+    if (eglMakeCurrent(state.egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, window->egl_context) == EGL_FALSE) {
+        present_thread_free(window, present);
+        return MW_FAILED_TO_MAKE_EGL_CONTEXT_CURRENT;
+    }
+
+    // The present thread paces the window itself, so a frame callback of an earlier batched present is not needed anymore
+    if (window->frame_callback != NULL) {
+        wl_callback_destroy(window->frame_callback);
+        window->frame_callback = NULL;
+    }
+
+    // From now on the window's events are read into the thread's queue.
+    // Events that have already been read into the default queue are handled here, before the thread starts.
+    present->queue = wl_display_create_queue(state.display);
+    wl_proxy_set_queue((struct wl_proxy *) window->wayland_surface, present->queue);
+    wl_proxy_set_queue((struct wl_proxy *) window->xdg_surface, present->queue);
+    wl_proxy_set_queue((struct wl_proxy *) window->xdg_toplevel, present->queue);
+    wl_display_dispatch_pending(state.display);
+
+    present->width = window->current_width;
+    present->height = window->current_height;
+    present->states = window->states;
+
+    window->present_thread = present;
+    if (pthread_create(&present->thread, NULL, present_thread_main, (void *) window) != 0) {
+        window->present_thread = NULL;
+        present_thread_free(window, present);
+        eglMakeCurrent(state.egl_display, window->egl_surface, window->egl_surface, window->egl_context);
+        return MW_FAILED_THREAD_CREATION;
+    }
+    return MW_SUCCESS;
+}
+
+MW_Error MW_present_thread_make_current(MW_Window *window) {
+    struct MW_PresentThread *present = window->present_thread;
+    if (eglMakeCurrent(state.egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, window->egl_context) == EGL_FALSE) {
+        return MW_FAILED_TO_MAKE_EGL_CONTEXT_CURRENT;
+    }
+    if (present->rendering_slot != -1) {
+        procs.bind_framebuffer(GL_FRAMEBUFFER, present->slots[present->rendering_slot].framebuffer);
+    }
+    return MW_SUCCESS;
+}
+
+MW_Error MW_Window_begin_frame(MW_Window *window, int32_t *width, int32_t *height) {
+    MW_CHECK_INITIALISED();
+    MW_CHECK_WINDOW_NONNULL(window);
+    MW_CHECK_NONNULL(width);
+    MW_CHECK_NONNULL(height);
+
+    struct MW_PresentThread *present = window->present_thread;
+    if (present == NULL) {
+        return MW_PRESENT_THREAD_NOT_RUNNING;
+    }
+
+    if (eglGetCurrentContext() != window->egl_context &&
+            eglMakeCurrent(state.egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, window->egl_context) == EGL_FALSE) {
+        return MW_FAILED_TO_MAKE_EGL_CONTEXT_CURRENT;
+    }
+
+    if (present->rendering_slot == -1) {
+        pthread_mutex_lock(&present->mutex);
+        int free_slot = -1;
+        while (present->error == MW_SUCCESS && free_slot == -1) {
+            for (unsigned int i = 0; i < present->slot_count && free_slot == -1; i++) {
+                if (present->slots[i].state == SLOT_FREE) {
+                    free_slot = (int) i;
+                }
+            }
+            if (free_slot == -1) {
+                pthread_cond_wait(&present->slot_freed, &present->mutex);
+            }
+        }
+        MW_Error error = present->error;
+        int32_t window_width = present->width > 0 ? present->width : 1;
+        int32_t window_height = present->height > 0 ? present->height : 1;
+        if (error == MW_SUCCESS) {
+            present->slots[free_slot].state = SLOT_RENDERING;
+        }
+        pthread_mutex_unlock(&present->mutex);
+
+        if (error != MW_SUCCESS) {
+            return error;
+        }
+
+        PresentSlot *slot = &present->slots[free_slot];
+        // The new frame must not overwrite the slot before the present thread has finished copying the last one out of it
+        fence_wait(&slot->release_fence);
+        if (slot->framebuffer == 0 || slot->width != window_width || slot->height != window_height) {
+            slot_resize(slot, window_width, window_height);
+        }
+        present->rendering_slot = free_slot;
+    }
+
+    PresentSlot *slot = &present->slots[present->rendering_slot];
+    procs.bind_framebuffer(GL_FRAMEBUFFER, slot->framebuffer);
+    glViewport(0, 0, slot->width, slot->height);
+    *width = slot->width;
+    *height = slot->height;
+    return MW_SUCCESS;
+}
+
+MW_Error MW_present_thread_submit(MW_Window *window) {
+    struct MW_PresentThread *present = window->present_thread;
+    if (present->rendering_slot == -1) {
+        return MW_INVALID_WINDOW_STATE;
+    }
+
+    // Batched presents may hand over the frames of several windows without making each of them current
+    if (eglGetCurrentContext() != window->egl_context &&
+            eglMakeCurrent(state.egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, window->egl_context) == EGL_FALSE) {
+        return MW_FAILED_TO_MAKE_EGL_CONTEXT_CURRENT;
+    }
+
+    // The fence has to reach the GPU before the present thread can wait for it
+    PresentSlot *slot = &present->slots[present->rendering_slot];
+    slot->render_fence = procs.create_sync(state.egl_display, EGL_SYNC_FENCE_KHR, NULL);
+    glFlush();
+    procs.bind_framebuffer(GL_FRAMEBUFFER, 0);
+    present->rendering_slot = -1;
+
+    pthread_mutex_lock(&present->mutex);
+    slot->state = SLOT_QUEUED;
+    slot->sequence = present->next_sequence++;
+    MW_Error error = present->error;
+    pthread_mutex_unlock(&present->mutex);
+
+    present_thread_wake(present);
+    return error;
+}
+
+void MW_present_thread_lock(MW_Window *window) {
+    if (window->present_thread != NULL) {
+        pthread_mutex_lock(&window->present_thread->mutex);
+    }
+}
+
+void MW_present_thread_unlock(MW_Window *window) {
+    if (window->present_thread != NULL) {
+        pthread_mutex_unlock(&window->present_thread->mutex);
+    }
+}
+
+uint32_t MW_present_thread_get_states(MW_Window *window) {
+    struct MW_PresentThread *present = window->present_thread;
+    pthread_mutex_lock(&present->mutex);
+    uint32_t states = present->states;
+    pthread_mutex_unlock(&present->mutex);
+    return states;
+}
+
+void MW_present_thread_stop(MW_Window *window) {
+    struct MW_PresentThread *present = window->present_thread;
+
+    pthread_mutex_lock(&present->mutex);
+    present->stopping = true;
+    pthread_mutex_unlock(&present->mutex);
+    present_thread_wake(present);
+    pthread_join(present->thread, NULL);
+
+    window->present_thread = NULL;
+    present_thread_free(window, present);
+}
+
+MW_Error MW_Window_stop_present_thread(MW_Window *window) {
+    MW_CHECK_INITIALISED();
+    MW_CHECK_WINDOW_NONNULL(window);
+
+    if (window->present_thread == NULL) {
+        return MW_PRESENT_THREAD_NOT_RUNNING;
+    }
+
+    MW_present_thread_stop(window);
+    if (eglMakeCurrent(state.egl_display, window->egl_surface, window->egl_surface, window->egl_context) == EGL_FALSE) {
+        return MW_FAILED_TO_MAKE_EGL_CONTEXT_CURRENT;
+    }
+
+    // The present thread has set the swap interval to 0 to pace the window itself
+    eglSwapInterval(state.egl_display, window->swap_interval);
+    return MW_SUCCESS;
+}
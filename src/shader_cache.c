@@ -0,0 +1,388 @@
+// flock(), ftruncate() and mmap() are not part of C17
+#define _GNU_SOURCE
+
+#include "../include/uwindow.h"
+#include "internal.h"
+#include <EGL/eglext.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SHADER_CACHE_MAGIC 0x4843414348534d57ULL // "MWSHCACH"
+#define SHADER_CACHE_VERSION 1
+
+// One entry slot is reserved for every this many bytes of the cache file
+#define BYTES_PER_ENTRY 2048
+
+#define ALIGN_8(n) (((n) + 7) & ~(uint64_t) 7)
+
+
+// The layout of the cache file:
+// [CacheHeader][CacheEntry * entry_capacity][data area]
+// Entries are packed at the start of the entry table. Each entry points to its key followed by its value in the data
+// area, which is filled like a stack and compacted when evictions have left too many holes in it.
+
+typedef struct {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t entry_capacity;
+    uint64_t file_size;
+    uint64_t data_used;
+    uint64_t clock;
+    uint32_t entry_count;
+    uint32_t checksum;
+} CacheHeader;
+
+typedef struct {
+    uint64_t key_hash;
+    uint64_t offset;
+    uint64_t last_used;
+    uint32_t key_size;
+    uint32_t value_size;
+    uint32_t checksum;
+    uint32_t padding;
+} CacheEntry;
+
+// The EGL cache callbacks have no user data pointer and may be called from driver threads,
+// so the cache is protected by a mutex that outlives any initialisation of the library
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+// Cache file helpers
+
+static uint32_t fnv1a_32(uint32_t hash, const unsigned char *data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static uint64_t fnv1a_64(const unsigned char *data, size_t size) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static CacheHeader *cache_header() {
+    return (CacheHeader *) state.shader_cache;
+}
+
+static CacheEntry *cache_entries() {
+    return (CacheEntry *) (state.shader_cache + sizeof(CacheHeader));
+}
+
+static unsigned char *cache_data() {
+    return state.shader_cache + sizeof(CacheHeader) + cache_header()->entry_capacity * sizeof(CacheEntry);
+}
+
+static uint64_t cache_data_capacity() {
+    return state.shader_cache_size - sizeof(CacheHeader) - cache_header()->entry_capacity * sizeof(CacheEntry);
+}
+
+static uint32_t header_checksum(const CacheHeader *header) {
+    return fnv1a_32(2166136261u, (const unsigned char *) header, offsetof(CacheHeader, checksum));
+}
+
+static uint32_t entry_checksum(const CacheEntry *entry) {
+    return fnv1a_32(2166136261u, cache_data() + entry->offset, (size_t) entry->key_size + entry->value_size);
+}
+
+static void cache_reset() {
+    CacheHeader *header = cache_header();
+    *header = (const CacheHeader) { 0 };
+    header->magic = SHADER_CACHE_MAGIC;
+    header->version = SHADER_CACHE_VERSION;
+    header->entry_capacity = state.shader_cache_size / BYTES_PER_ENTRY;
+    header->file_size = state.shader_cache_size;
+    header->checksum = header_checksum(header);
+}
+
+static bool cache_valid() {
+    const CacheHeader *header = cache_header();
+    return header->magic == SHADER_CACHE_MAGIC &&
+        header->version == SHADER_CACHE_VERSION &&
+        header->file_size == state.shader_cache_size &&
+        header->entry_capacity == state.shader_cache_size / BYTES_PER_ENTRY &&
+        header->entry_count <= header->entry_capacity &&
+        header->data_used <= cache_data_capacity() &&
+        header->checksum == header_checksum(header);
+}
+
+// Takes both the thread lock and the file lock, which guards against other processes using the same cache file.
+// A damaged header (for example after a crash during an update) resets the whole cache.
+static bool cache_lock() {
+    pthread_mutex_lock(&cache_mutex);
+    if (state.shader_cache == NULL) {
+        pthread_mutex_unlock(&cache_mutex);
+        return false;
+    }
+    flock(state.shader_cache_fd, LOCK_EX);
+
+    // Another process using a different cache size may have resized the file, in which case accessing the mapping
+    // could fault. The cache is skipped until that process has finished with it.
+    struct stat file_stat;
+    if (fstat(state.shader_cache_fd, &file_stat) == -1 || (size_t) file_stat.st_size != state.shader_cache_size) {
+        flock(state.shader_cache_fd, LOCK_UN);
+        pthread_mutex_unlock(&cache_mutex);
+        return false;
+    }
+
+    if (!cache_valid()) {
+        cache_reset();
+    }
+    return true;
+}
+
+static void cache_unlock() {
+    CacheHeader *header = cache_header();
+    header->checksum = header_checksum(header);
+    flock(state.shader_cache_fd, LOCK_UN);
+    pthread_mutex_unlock(&cache_mutex);
+}
+
+static void cache_remove(uint32_t index) {
+    CacheHeader *header = cache_header();
+    CacheEntry *entries = cache_entries();
+    entries[index] = entries[--header->entry_count];
+}
+
+// Drops entries that point outside of the used data area, which can only happen if the file was damaged
+static void cache_drop_damaged_entries() {
+    CacheHeader *header = cache_header();
+    CacheEntry *entries = cache_entries();
+    uint32_t i = 0;
+    while (i < header->entry_count) {
+        uint64_t end = entries[i].offset + (uint64_t) entries[i].key_size + entries[i].value_size;
+        if (end < entries[i].offset || end > header->data_used) {
+            cache_remove(i);
+        } else {
+            i++;
+        }
+    }
+}
+
+static CacheEntry *cache_find(const void *key, uint32_t key_size, uint64_t key_hash) {
+    CacheHeader *header = cache_header();
+    CacheEntry *entries = cache_entries();
+    for (uint32_t i = 0; i < header->entry_count; i++) {
+        if (entries[i].key_hash == key_hash && entries[i].key_size == key_size &&
+                memcmp(cache_data() + entries[i].offset, key, key_size) == 0) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+// Returns the number of data bytes freed by the eviction
+static uint64_t cache_evict_lru() {
+    CacheHeader *header = cache_header();
+    CacheEntry *entries = cache_entries();
+    uint32_t lru = 0;
+    for (uint32_t i = 1; i < header->entry_count; i++) {
+        if (entries[i].last_used < entries[lru].last_used) {
+            lru = i;
+        }
+    }
+    uint64_t freed = ALIGN_8((uint64_t) entries[lru].key_size + entries[lru].value_size);
+    cache_remove(lru);
+    return freed;
+}
+
+static int compare_entry_offsets(const void *a, const void *b) {
+    const CacheEntry *entry_a = (const CacheEntry *) a;
+    const CacheEntry *entry_b = (const CacheEntry *) b;
+    return (entry_a->offset > entry_b->offset) - (entry_a->offset < entry_b->offset);
+}
+
+// Moves all entries to the start of the data area, closing the holes left by removed entries
+static void cache_compact() {
+    CacheHeader *header = cache_header();
+    CacheEntry *entries = cache_entries();
+    unsigned char *data = cache_data();
+
+    qsort(entries, header->entry_count, sizeof(CacheEntry), compare_entry_offsets);
+
+    uint64_t offset = 0;
+    for (uint32_t i = 0; i < header->entry_count; i++) {
+        uint64_t size = (uint64_t) entries[i].key_size + entries[i].value_size;
+        if (entries[i].offset != offset) {
+            memmove(data + offset, data + entries[i].offset, size);
+            entries[i].offset = offset;
+        }
+        offset += ALIGN_8(size);
+    }
+    header->data_used = offset;
+}
+
+static uint64_t cache_live_bytes() {
+    CacheHeader *header = cache_header();
+    CacheEntry *entries = cache_entries();
+    uint64_t live = 0;
+    for (uint32_t i = 0; i < header->entry_count; i++) {
+        live += ALIGN_8((uint64_t) entries[i].key_size + entries[i].value_size);
+    }
+    return live;
+}
+
+
+// EGL_ANDROID_blob_cache callbacks
+
+static void cache_set(const void *key, EGLsizeiANDROID key_size, const void *value, EGLsizeiANDROID value_size) {
+    if (key_size <= 0 || value_size <= 0 || key_size > UINT32_MAX || value_size > UINT32_MAX) {
+        return;
+    }
+    if (!cache_lock()) {
+        return;
+    }
+
+    CacheHeader *header = cache_header();
+    uint64_t needed = ALIGN_8((uint64_t) key_size + value_size);
+    if (needed > cache_data_capacity()) {
+        cache_unlock();
+        return;
+    }
+
+    uint64_t key_hash = fnv1a_64(key, key_size);
+    CacheEntry *existing = cache_find(key, key_size, key_hash);
+    if (existing != NULL) {
+        cache_remove(existing - cache_entries());
+    }
+
+    uint64_t live = cache_live_bytes();
+    while (header->entry_count > 0 &&
+            (header->entry_count >= header->entry_capacity || live + needed > cache_data_capacity())) {
+        live -= cache_evict_lru();
+    }
+    if (header->data_used + needed > cache_data_capacity()) {
+        cache_compact();
+    }
+
+    // The data is written before the entry that points to it, and the entry checksum covers both key and value,
+    // so an update torn by a crash is detected when the entry is read the next time
+    CacheEntry *entry = &cache_entries()[header->entry_count];
+    entry->offset = header->data_used;
+    memcpy(cache_data() + entry->offset, key, key_size);
+    memcpy(cache_data() + entry->offset + key_size, value, value_size);
+    entry->key_hash = key_hash;
+    entry->key_size = key_size;
+    entry->value_size = value_size;
+    entry->last_used = ++header->clock;
+    entry->checksum = entry_checksum(entry);
+    entry->padding = 0;
+
+    header->data_used += needed;
+    header->entry_count++;
+
+    cache_unlock();
+}
+
+static EGLsizeiANDROID cache_get(const void *key, EGLsizeiANDROID key_size, void *value, EGLsizeiANDROID value_size) {
+    if (key_size <= 0 || key_size > UINT32_MAX) {
+        return 0;
+    }
+    if (!cache_lock()) {
+        return 0;
+    }
+
+    CacheEntry *entry = cache_find(key, key_size, fnv1a_64(key, key_size));
+    if (entry == NULL) {
+        cache_unlock();
+        return 0;
+    }
+    if (entry->checksum != entry_checksum(entry)) {
+        cache_remove(entry - cache_entries());
+        cache_unlock();
+        return 0;
+    }
+
+    entry->last_used = ++cache_header()->clock;
+
+    // If the buffer is too small, the driver calls again with a buffer of the returned size
+    EGLsizeiANDROID size = entry->value_size;
+    if (value != NULL && size <= value_size) {
+        memcpy(value, cache_data() + entry->offset + entry->key_size, size);
+    }
+
+    cache_unlock();
+    return size;
+}
+
+
+MW_Error MW_enable_shader_cache(const char *path, size_t max_size) {
+    MW_CHECK_INITIALISED();
+    MW_CHECK_NONNULL(path);
+
+    if (max_size < MW_SHADER_CACHE_MIN_SIZE) {
+        return MW_INVALID_PARAM;
+    }
+    if (state.shader_cache != NULL) {
+        return MW_SHADER_CACHE_ALREADY_ENABLED;
+    }
+
+    PFNEGLSETBLOBCACHEFUNCSANDROIDPROC set_blob_cache_funcs = NULL;
+    if (MW_has_egl_extension("EGL_ANDROID_blob_cache")) {
+        set_blob_cache_funcs = (PFNEGLSETBLOBCACHEFUNCSANDROIDPROC) eglGetProcAddress("eglSetBlobCacheFuncsANDROID");
+    }
+    if (set_blob_cache_funcs == NULL) {
+        return MW_NO_BLOB_CACHE_EXTENSION;
+    }
+
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        return MW_FAILED_SHADER_CACHE_OPEN;
+    }
+
+    // The blocks of the file are reserved up front. A sparse file would only get its blocks when a page of the mapping is
+    // first written, and a full disk would then raise SIGBUS inside the driver's cache callback.
+    // This also fills in files left sparse by other writers, so it is done even if the size is already right.
+    flock(fd, LOCK_EX);
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == -1 ||
+            ((size_t) file_stat.st_size > max_size && ftruncate(fd, max_size) == -1) ||
+            posix_fallocate(fd, 0, max_size) != 0) {
+        flock(fd, LOCK_UN);
+        close(fd);
+        return MW_FAILED_SHADER_CACHE_OPEN;
+    }
+
+    unsigned char *map = mmap(NULL, max_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return MW_FAILED_SHADER_CACHE_OPEN;
+    }
+
+    pthread_mutex_lock(&cache_mutex);
+    state.shader_cache_fd = fd;
+    state.shader_cache = map;
+    state.shader_cache_size = max_size;
+    if (cache_valid()) {
+        cache_drop_damaged_entries();
+        cache_header()->checksum = header_checksum(cache_header());
+    } else {
+        cache_reset();
+    }
+    pthread_mutex_unlock(&cache_mutex);
+    flock(fd, LOCK_UN);
+
+    set_blob_cache_funcs(state.egl_display, cache_set, cache_get);
+    return MW_SUCCESS;
+}
+
+void MW_shader_cache_cleanup() {
+    pthread_mutex_lock(&cache_mutex);
+    if (state.shader_cache != NULL) {
+        munmap(state.shader_cache, state.shader_cache_size);
+        close(state.shader_cache_fd);
+        state.shader_cache = NULL;
+        state.shader_cache_size = 0;
+    }
+    pthread_mutex_unlock(&cache_mutex);
+}
@@ -1,8 +1,17 @@
 #include "../include/uwindow.h"
 
 #include "internal.h"
+#include <stdlib.h>
 #include <string.h>
 
+// Version 6 of xdg_wm_base is needed for the compositor to report suspended windows.
+// Protocol headers too old to know about the suspended state only get version 1.
+#ifdef XDG_TOPLEVEL_STATE_SUSPENDED_SINCE_VERSION
+#define XDG_WM_BASE_VERSION XDG_TOPLEVEL_STATE_SUSPENDED_SINCE_VERSION
+#else
+#define XDG_WM_BASE_VERSION 1
+#endif
+
 
 // Zero initialise the internal library state
 MW_LibState state = { 0 };
@@ -19,12 +28,20 @@ static const struct xdg_wm_base_listener wm_base_listener = {
 };
 
 static void reg_handler(__attribute__((unused))void * data, struct wl_registry *reg,
-        uint32_t id, const char *interface, __attribute__((unused))uint32_t ver) {
+        uint32_t id, const char *interface, uint32_t ver) {
     if (strcmp(interface, "wl_compositor") == 0) {
         state.compositor = wl_registry_bind(reg, id, &wl_compositor_interface, 1);
     } else if (strcmp(interface, "xdg_wm_base") == 0) {
-        state.wm_base = wl_registry_bind(reg, id, &xdg_wm_base_interface, 1);
+        state.wm_base = wl_registry_bind(reg, id, &xdg_wm_base_interface,
+                ver < XDG_WM_BASE_VERSION ? ver : XDG_WM_BASE_VERSION);
         xdg_wm_base_add_listener(state.wm_base, &wm_base_listener, NULL);
+    } else if (strcmp(interface, "wl_shm") == 0) {
+        state.shm = wl_registry_bind(reg, id, &wl_shm_interface, 1);
+    } else if (strcmp(interface, "wl_seat") == 0 && state.seat == NULL) {
+        state.seat = wl_registry_bind(reg, id, &wl_seat_interface, 1);
+        wl_seat_add_listener(state.seat, &MW_seat_listener, NULL);
+    } else if (strcmp(interface, "wl_data_device_manager") == 0) {
+        state.data_device_manager = wl_registry_bind(reg, id, &wl_data_device_manager_interface, 1);
     }
 }
 
@@ -40,6 +57,46 @@ static const struct wl_registry_listener reg_listener = {
 };
 
 
+// eglChooseConfig treats the alpha size as a minimum and does not sort by it, so an RGB request may return a config with
+// an alpha channel. If exact is set, this picks the first matching config whose alpha size is exactly the requested one,
+// otherwise simply the first matching config.
+static bool choose_egl_config(EGLint alpha_size, bool exact, EGLConfig *config) {
+    const EGLint attr[] = {
+        EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, alpha_size,
+        EGL_NONE
+    };
+    // Drivers may list many variants (e.g. multisampled ones) before the wanted config, so all configs are searched
+    EGLint num_config;
+    if (eglChooseConfig(state.egl_display, attr, NULL, 0, &num_config) == EGL_FALSE || num_config <= 0) {
+        return false;
+    }
+    EGLConfig *configs = malloc(num_config * sizeof(EGLConfig));
+    if (configs == NULL) {
+        return false;
+    }
+    if (eglChooseConfig(state.egl_display, attr, configs, num_config, &num_config) == EGL_FALSE) {
+        free(configs);
+        return false;
+    }
+
+    bool found = false;
+    for (EGLint i = 0; i < num_config && !found; i++) {
+        EGLint config_alpha_size;
+        if (!exact || (eglGetConfigAttrib(state.egl_display, configs[i], EGL_ALPHA_SIZE, &config_alpha_size) == EGL_TRUE &&
+                config_alpha_size == alpha_size)) {
+            *config = configs[i];
+            found = true;
+        }
+    }
+    free(configs);
+    return found;
+}
+
+
 MW_Error MW_init() {
     if (state.initialised == true) {
         return MW_ALREADY_INITIALISED;
@@ -66,14 +123,12 @@ MW_Error MW_init() {
         return MW_FAILED_EGL_DISPLAY_INIT;
     }
 
-    const EGLint attr[] = {
-        EGL_RED_SIZE, 8,
-        EGL_GREEN_SIZE, 8,
-        EGL_BLUE_SIZE, 8,
-        EGL_NONE
-    };
-    EGLint num_config;
-    if (eglChooseConfig(state.egl_display, attr, &state.egl_config, 1, &num_config) == EGL_FALSE) {
+    // Without an alpha config only translucent windows cannot be created
+    state.has_egl_config_alpha = choose_egl_config(8, true, &state.egl_config_alpha);
+
+    // Opaque windows prefer a config without alpha, but can use any RGB config since their whole surface is marked as
+    // opaque, which tells the compositor to ignore the alpha channel
+    if (!choose_egl_config(0, true, &state.egl_config) && !choose_egl_config(0, false, &state.egl_config)) {
         state.initialised = false;
         MW_finish();
         return MW_NO_EGL_CONFIG;
@@ -105,7 +160,11 @@ MW_Error MW_init() {
         return MW_NO_WM_BASE;
     }
 
+    // The clipboard and drag and drop are optional as well, so a missing data device manager is not an error
+    MW_data_device_setup();
 
+    // A missing cursor theme only disables custom cursors, so the return value is deliberately ignored
+    MW_set_cursor_theme(NULL, 0);
 
     return MW_SUCCESS;
 }
@@ -113,6 +172,10 @@ MW_Error MW_init() {
 void MW_finish() {
     // TODO: If initialised, deinit all allocated windows
 
+    MW_data_device_cleanup();
+    MW_cursor_cleanup();
+    MW_shader_cache_cleanup();
+
     if (state.egl_display != NULL) {
         eglTerminate(state.egl_display);
     }
@@ -132,6 +195,7 @@ MW_Error MW_process_events() {
     if (wl_display_dispatch_pending(state.display) == -1) {
         return MW_FAILED_DISPLAY_DISPATCH;
     }
+    MW_transfers_process();
     if (wl_display_flush(state.display) == -1) {
         return MW_FAILED_DISPLAY_FLUSH;
     }
@@ -141,12 +205,43 @@ MW_Error MW_process_events() {
 MW_Error MW_process_events_blocking() {
     MW_CHECK_INITIALISED();
 
-    if (wl_display_dispatch(state.display) == -1) {
+    // While data is being transferred, the transfer fds are waited on together with the display,
+    // so that a transfer can never be stalled by a lack of wayland events
+    if (state.transfers != NULL) {
+        MW_Error status = MW_transfers_wait();
+        if (status != MW_SUCCESS) {
+            return status;
+        }
+    } else if (wl_display_dispatch(state.display) == -1) {
         return MW_FAILED_DISPLAY_DISPATCH;
     }
     if (wl_display_roundtrip(state.display) == -1) {
         return MW_FAILED_DISPLAY_ROUNDTRIP;
     }
+    MW_transfers_process();
     return MW_SUCCESS;
 }
 
+EGLDisplay MW_get_egl_display() {
+    if (!state.initialised) {
+        return EGL_NO_DISPLAY;
+    }
+    return state.egl_display;
+}
+
+bool MW_has_egl_extension(const char *name) {
+    const char *extensions = eglQueryString(state.egl_display, EGL_EXTENSIONS);
+    if (extensions == NULL) {
+        return false;
+    }
+
+    size_t name_length = strlen(name);
+    for (const char *match = strstr(extensions, name); match != NULL; match = strstr(match + 1, name)) {
+        bool starts_word = match == extensions || match[-1] == ' ';
+        bool ends_word = match[name_length] == ' ' || match[name_length] == '\0';
+        if (starts_word && ends_word) {
+            return true;
+        }
+    }
+    return false;
+}
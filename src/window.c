@@ -1,16 +1,65 @@
 #include "../include/uwindow.h"
 #include "internal.h"
+#include <string.h>
 
 #define DEFAULT_PREFERRED_WIDTH 800
 #define DEFAULT_PREFERRED_HEIGHT 600
 
 
+// Tells the compositor which part of the window does not need to be blended with what is behind it.
+// Opaque windows are opaque as a whole, translucent windows only in the region set by the user.
+static void window_update_opaque_region(MW_Window *window) {
+    struct wl_region *region = NULL;
+
+    if (window->transparency == MW_WINDOW_OPAQUE) {
+        region = wl_compositor_create_region(state.compositor);
+        wl_region_add(region, 0, 0, window->current_width, window->current_height);
+    } else if (window->opaque_width > 0 && window->opaque_height > 0) {
+        region = wl_compositor_create_region(state.compositor);
+        wl_region_add(region, window->opaque_x, window->opaque_y, window->opaque_width, window->opaque_height);
+    }
+
+    // The region is copied by the compositor, so it can be destroyed right away
+    wl_surface_set_opaque_region(window->wayland_surface, region);
+    if (region != NULL) {
+        wl_region_destroy(region);
+    }
+}
+
+
 // Wayland xdg event listeners
 
 static void xdg_toplevel_configure(void *data, __attribute__((unused))struct xdg_toplevel *xdg_toplevel,
-        int32_t width, int32_t height, __attribute__((unused))struct wl_array *states) {
+        int32_t width, int32_t height, struct wl_array *states) {
     MW_Window *window = (MW_Window *) data;
 
+    // The states are only applied once the whole configure sequence has been received in xdg_surface_configure
+    window->pending_states = 0;
+    uint32_t *toplevel_state;
+    wl_array_for_each(toplevel_state, states) {
+        switch (*toplevel_state) {
+            case XDG_TOPLEVEL_STATE_MAXIMIZED:
+                window->pending_states |= MW_WINDOW_STATE_MAXIMIZED;
+                break;
+            case XDG_TOPLEVEL_STATE_FULLSCREEN:
+                window->pending_states |= MW_WINDOW_STATE_FULLSCREEN;
+                break;
+            case XDG_TOPLEVEL_STATE_RESIZING:
+                window->pending_states |= MW_WINDOW_STATE_RESIZING;
+                break;
+            case XDG_TOPLEVEL_STATE_ACTIVATED:
+                window->pending_states |= MW_WINDOW_STATE_ACTIVATED;
+                break;
+#ifdef XDG_TOPLEVEL_STATE_SUSPENDED_SINCE_VERSION
+            case XDG_TOPLEVEL_STATE_SUSPENDED:
+                window->pending_states |= MW_WINDOW_STATE_SUSPENDED;
+                break;
+#endif
+            default:
+                break;
+        }
+    }
+
     if (width == 0) {
         width = window->preferred_width;
     }
@@ -25,8 +74,35 @@ static void xdg_toplevel_configure(void *data, __attribute__((unused))struct xdg
     }
 }
 
+static void xdg_toplevel_close(
+        __attribute__((unused))void *data,
+        __attribute__((unused))struct xdg_toplevel *xdg_toplevel) {
+}
+
+#ifdef XDG_TOPLEVEL_STATE_SUSPENDED_SINCE_VERSION
+// The events added between version 1 and the version needed for the suspended state have to be handled as well,
+// since the listener is not allowed to have NULL entries for events the compositor may send
+static void xdg_toplevel_configure_bounds(
+        __attribute__((unused))void *data,
+        __attribute__((unused))struct xdg_toplevel *xdg_toplevel,
+        __attribute__((unused))int32_t width,
+        __attribute__((unused))int32_t height) {
+}
+
+static void xdg_toplevel_wm_capabilities(
+        __attribute__((unused))void *data,
+        __attribute__((unused))struct xdg_toplevel *xdg_toplevel,
+        __attribute__((unused))struct wl_array *capabilities) {
+}
+#endif
+
 static const struct xdg_toplevel_listener toplevel_listener = {
-    .configure = xdg_toplevel_configure
+    .configure = xdg_toplevel_configure,
+    .close = xdg_toplevel_close,
+#ifdef XDG_TOPLEVEL_STATE_SUSPENDED_SINCE_VERSION
+    .configure_bounds = xdg_toplevel_configure_bounds,
+    .wm_capabilities = xdg_toplevel_wm_capabilities
+#endif
 };
 
 static void xdg_surface_configure(void *data, struct xdg_surface *xdg_surface, uint32_t serial) {
@@ -34,9 +110,27 @@ static void xdg_surface_configure(void *data, struct xdg_surface *xdg_surface, u
 
     if (window->resize_needed) {
         wl_egl_window_resize(window->egl_window, window->current_width, window->current_height, 0, 0);
+        if (window->transparency == MW_WINDOW_OPAQUE) {
+            window_update_opaque_region(window);
+        }
         window->resize_needed = false;
-        if (window->resize_cb != NULL) {
-            window->resize_cb(window->current_width, window->current_height);
+        // The callbacks are called without holding the lock, so that they can set the callbacks themselves
+        MW_present_thread_lock(window);
+        MW_Window_resize_cb resize_cb = window->resize_cb;
+        MW_present_thread_unlock(window);
+        if (resize_cb != NULL) {
+            resize_cb(window->current_width, window->current_height);
+        }
+    }
+
+    if (window->pending_states != window->states) {
+        uint32_t changed_states = window->pending_states ^ window->states;
+        window->states = window->pending_states;
+        MW_present_thread_lock(window);
+        MW_Window_state_cb state_cb = window->state_cb;
+        MW_present_thread_unlock(window);
+        if (state_cb != NULL) {
+            state_cb(window->states, changed_states);
         }
     }
 
@@ -48,10 +142,40 @@ static const struct xdg_surface_listener xdg_surface_listener = {
 };
 
 
+// Wayland frame callback listener used to pace batched presents
+
+static void window_frame_done(void *data, struct wl_callback *callback, __attribute__((unused))uint32_t time) {
+    MW_Window *window = (MW_Window *) data;
+    wl_callback_destroy(callback);
+    window->frame_callback = NULL;
+}
+
+static const struct wl_callback_listener frame_listener = {
+    .done = window_frame_done
+};
+
+
 MW_Error MW_Window_create(MW_Window *window, const char *title, int32_t preferred_width, int32_t preferred_height) {
+    return MW_Window_create_with_transparency(window, title, preferred_width, preferred_height, MW_WINDOW_OPAQUE);
+}
+
+MW_Error MW_Window_create_with_transparency(MW_Window *window, const char *title, int32_t preferred_width,
+        int32_t preferred_height, MW_Window_transparency transparency) {
+    return MW_Window_create_with_attribs(window, title, preferred_width, preferred_height, transparency, NULL);
+}
+
+MW_Error MW_Window_create_with_attribs(MW_Window *window, const char *title, int32_t preferred_width,
+        int32_t preferred_height, MW_Window_transparency transparency, const EGLint *context_attribs) {
     MW_CHECK_INITIALISED();
     MW_CHECK_NONNULL(title);
 
+    if (transparency != MW_WINDOW_OPAQUE && transparency != MW_WINDOW_TRANSLUCENT) {
+        return MW_INVALID_PARAM;
+    }
+    if (transparency == MW_WINDOW_TRANSLUCENT && !state.has_egl_config_alpha) {
+        return MW_NO_EGL_CONFIG;
+    }
+
     if (preferred_width == 0) {
         preferred_width = DEFAULT_PREFERRED_WIDTH;
     }
@@ -72,10 +196,22 @@ MW_Error MW_Window_create(MW_Window *window, const char *title, int32_t preferre
     window->current_height = preferred_height;
     window->resize_needed = false;
     window->resize_cb = NULL;
-
-    window->egl_context = eglCreateContext(state.egl_display, state.egl_config, EGL_NO_CONTEXT, NULL);
+    strcpy(window->cursor_name, "left_ptr");
+    window->drop_cb = NULL;
+    window->transparency = transparency;
+    window->egl_config = transparency == MW_WINDOW_OPAQUE ? state.egl_config : state.egl_config_alpha;
+    window->swap_interval = 1;
+
+    window->egl_context = eglCreateContext(state.egl_display, window->egl_config, EGL_NO_CONTEXT, context_attribs);
+    if (window->egl_context == EGL_NO_CONTEXT) {
+        window->egl_context = NULL;
+        MW_Window_destroy(window);
+        return MW_FAILED_EGL_CONTEXT_CREATION;
+    }
 
     window->wayland_surface = wl_compositor_create_surface(state.compositor);
+    // Lets the pointer event handlers find the window that the pointer entered
+    wl_surface_set_user_data(window->wayland_surface, (void *) window);
 
     window->xdg_surface = xdg_wm_base_get_xdg_surface(state.wm_base, window->wayland_surface);
     xdg_surface_add_listener(window->xdg_surface, &xdg_surface_listener, (void *) window);
@@ -84,6 +220,8 @@ MW_Error MW_Window_create(MW_Window *window, const char *title, int32_t preferre
     xdg_toplevel_add_listener(window->xdg_toplevel, &toplevel_listener, (void *) window);
     xdg_toplevel_set_title(window->xdg_toplevel, title);
 
+    window_update_opaque_region(window);
+
     wl_surface_commit(window->wayland_surface);
     MW_Error status = MW_process_events_blocking();
     if (status != MW_SUCCESS) {
@@ -92,7 +230,7 @@ MW_Error MW_Window_create(MW_Window *window, const char *title, int32_t preferre
     }
 
     window->egl_window = wl_egl_window_create(window->wayland_surface, preferred_width, preferred_height);
-    window->egl_surface = eglCreateWindowSurface(state.egl_display, state.egl_config, window->egl_window, NULL);
+    window->egl_surface = eglCreateWindowSurface(state.egl_display, window->egl_config, window->egl_window, NULL);
 
     // One buffer swap updates the window which causes the configure handlers to be called with
     // the initial position of the window.
@@ -114,13 +252,87 @@ MW_Error MW_Window_create(MW_Window *window, const char *title, int32_t preferre
 MW_Error MW_Window_set_resize_callback(MW_Window *window, MW_Window_resize_cb callback) {
     MW_CHECK_INITIALISED();
     MW_CHECK_WINDOW_NONNULL(window);
+    MW_present_thread_lock(window);
     window->resize_cb = callback;
+    MW_present_thread_unlock(window);
+    return MW_SUCCESS;
+}
+
+MW_Error MW_Window_set_opaque_region(MW_Window *window, int32_t x, int32_t y, int32_t width, int32_t height) {
+    MW_CHECK_INITIALISED();
+    MW_CHECK_WINDOW_NONNULL(window);
+
+    if (window->transparency != MW_WINDOW_TRANSLUCENT) {
+        return MW_INVALID_WINDOW_STATE;
+    }
+    if (width < 0 || height < 0) {
+        return MW_INVALID_PARAM;
+    }
+
+    window->opaque_x = x;
+    window->opaque_y = y;
+    window->opaque_width = width;
+    window->opaque_height = height;
+    window_update_opaque_region(window);
+    return MW_SUCCESS;
+}
+
+MW_Error MW_Window_set_state_callback(MW_Window *window, MW_Window_state_cb callback) {
+    MW_CHECK_INITIALISED();
+    MW_CHECK_WINDOW_NONNULL(window);
+    MW_present_thread_lock(window);
+    window->state_cb = callback;
+    MW_present_thread_unlock(window);
+    return MW_SUCCESS;
+}
+
+MW_Error MW_Window_get_states(MW_Window *window, uint32_t *states) {
+    MW_CHECK_INITIALISED();
+    MW_CHECK_WINDOW_NONNULL(window);
+    MW_CHECK_NONNULL(states);
+    *states = window->present_thread != NULL ? MW_present_thread_get_states(window) : window->states;
+    return MW_SUCCESS;
+}
+
+MW_Error MW_Window_set_skip_suspended_frames(MW_Window *window, bool skip) {
+    MW_CHECK_INITIALISED();
+    MW_CHECK_WINDOW_NONNULL(window);
+    MW_present_thread_lock(window);
+    window->skip_suspended_frames = skip;
+    MW_present_thread_unlock(window);
+    return MW_SUCCESS;
+}
+
+MW_Error MW_Window_set_swap_interval(MW_Window *window, EGLint interval) {
+    MW_CHECK_INITIALISED();
+    MW_CHECK_WINDOW_NONNULL(window);
+
+    if (interval < 0) {
+        return MW_INVALID_PARAM;
+    }
+    window->swap_interval = interval;
+    if (window->present_thread != NULL) {
+        return MW_SUCCESS;
+    }
+
+    // eglSwapInterval applies to the surface that is current, so the window is made current only for the call
+    EGLContext previous_context = eglGetCurrentContext();
+    EGLSurface previous_draw = eglGetCurrentSurface(EGL_DRAW);
+    EGLSurface previous_read = eglGetCurrentSurface(EGL_READ);
+    if (eglMakeCurrent(state.egl_display, window->egl_surface, window->egl_surface, window->egl_context) == EGL_FALSE) {
+        return MW_FAILED_TO_MAKE_EGL_CONTEXT_CURRENT;
+    }
+    eglSwapInterval(state.egl_display, interval);
+    eglMakeCurrent(state.egl_display, previous_draw, previous_read, previous_context);
     return MW_SUCCESS;
 }
 
 MW_Error MW_Window_make_current(MW_Window *window) {
     MW_CHECK_INITIALISED();
     MW_CHECK_WINDOW_NONNULL(window);
+    if (window->present_thread != NULL) {
+        return MW_present_thread_make_current(window);
+    }
     if (eglMakeCurrent(state.egl_display, window->egl_surface, window->egl_surface, window->egl_context) == EGL_TRUE) {
         return MW_SUCCESS;
     } else {
@@ -128,9 +340,20 @@ MW_Error MW_Window_make_current(MW_Window *window) {
     }
 }
 
+bool MW_window_skips_frame(const MW_Window *window) {
+    return window->skip_suspended_frames && (window->states & MW_WINDOW_STATE_SUSPENDED);
+}
+
 MW_Error MW_Window_swap_buffers(MW_Window *window) {
     MW_CHECK_INITIALISED();
     MW_CHECK_WINDOW_NONNULL(window);
+    // The present thread drops the frames of suspended windows itself, since it handles the window's states
+    if (window->present_thread != NULL) {
+        return MW_present_thread_submit(window);
+    }
+    if (MW_window_skips_frame(window)) {
+        return MW_SUCCESS;
+    }
     if (eglSwapBuffers(state.egl_display, window->egl_surface) == EGL_TRUE) {
         return MW_SUCCESS;
     } else {
@@ -138,6 +361,71 @@ MW_Error MW_Window_swap_buffers(MW_Window *window) {
     }
 }
 
+MW_Error MW_swap_buffers_batch(MW_Window *const *windows, size_t window_count) {
+    MW_CHECK_INITIALISED();
+    MW_CHECK_NONNULL(windows);
+    for (size_t i = 0; i < window_count; i++) {
+        MW_CHECK_NONNULL(windows[i]);
+        MW_CHECK_WINDOW_NONNULL(windows[i]);
+    }
+
+    // Wait for the compositor once for the whole batch instead of once per window inside eglSwapBuffers.
+    // Suspended windows are not waited for, since the compositor does not send frame callbacks for them.
+    bool waiting = true;
+    while (waiting) {
+        waiting = false;
+        for (size_t i = 0; i < window_count; i++) {
+            if (windows[i]->frame_callback != NULL && !(windows[i]->states & MW_WINDOW_STATE_SUSPENDED)) {
+                waiting = true;
+                break;
+            }
+        }
+        if (waiting && wl_display_dispatch(state.display) == -1) {
+            return MW_FAILED_DISPLAY_DISPATCH;
+        }
+    }
+
+    for (size_t i = 0; i < window_count; i++) {
+        MW_Window *window = windows[i];
+        if (window->present_thread != NULL) {
+            MW_Error status = MW_present_thread_submit(window);
+            if (status != MW_SUCCESS) {
+                return status;
+            }
+            continue;
+        }
+        if (MW_window_skips_frame(window)) {
+            continue;
+        }
+
+        if (eglMakeCurrent(state.egl_display, window->egl_surface, window->egl_surface, window->egl_context) == EGL_FALSE) {
+            return MW_FAILED_TO_MAKE_EGL_CONTEXT_CURRENT;
+        }
+        if (window->swap_interval != 0) {
+            eglSwapInterval(state.egl_display, 0);
+        }
+
+        // The frame request is queued before the commit made by eglSwapBuffers, so it applies to this frame
+        if (window->frame_callback == NULL) {
+            window->frame_callback = wl_surface_frame(window->wayland_surface);
+            wl_callback_add_listener(window->frame_callback, &frame_listener, (void *) window);
+        }
+
+        bool swapped = eglSwapBuffers(state.egl_display, window->egl_surface) == EGL_TRUE;
+        if (window->swap_interval != 0) {
+            eglSwapInterval(state.egl_display, window->swap_interval);
+        }
+        if (!swapped) {
+            return MW_FAILED_TO_SWAP_EGL_BUFFERS;
+        }
+    }
+
+    if (wl_display_flush(state.display) == -1) {
+        return MW_FAILED_DISPLAY_FLUSH;
+    }
+    return MW_SUCCESS;
+}
+
 MW_Error MW_Window_set_fullscreen(MW_Window *window, bool fullscreen) {
     MW_CHECK_INITIALISED();
     MW_CHECK_WINDOW_NONNULL(window);
@@ -150,6 +438,21 @@ MW_Error MW_Window_set_fullscreen(MW_Window *window, bool fullscreen) {
 }
 
 void MW_Window_destroy(MW_Window *window) {
+    if (window->present_thread != NULL) {
+        MW_present_thread_stop(window);
+    }
+    if (state.pointer_focus == window) {
+        state.pointer_focus = NULL;
+        state.cursor = NULL;
+        state.cursor_image = NULL;
+    }
+    if (state.drag_focus == window) {
+        state.drag_focus = NULL;
+    }
+    if (window->frame_callback != NULL) {
+        wl_callback_destroy(window->frame_callback);
+        window->frame_callback = NULL;
+    }
     if (state.egl_display != NULL && window->egl_surface != NULL) {
         eglDestroySurface(state.egl_display, window->egl_surface);
         window->egl_surface = NULL;
@@ -181,5 +484,18 @@ void MW_Window_destroy(MW_Window *window) {
     window->current_width = 0;
     window->current_height = 0;
     window->resize_cb = NULL;
+    window->cursor_name[0] = '\0';
+    window->drop_cb = NULL;
+    window->egl_config = NULL;
+    window->transparency = MW_WINDOW_OPAQUE;
+    window->opaque_x = 0;
+    window->opaque_y = 0;
+    window->opaque_width = 0;
+    window->opaque_height = 0;
+    window->swap_interval = 0;
+    window->states = 0;
+    window->pending_states = 0;
+    window->state_cb = NULL;
+    window->skip_suspended_frames = false;
 }
 